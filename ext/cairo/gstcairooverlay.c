@@ -85,6 +85,14 @@
  *
  * ]|
  *
+ * When #GstCairoOverlay:draw-on-transparent-surface is enabled, the draw
+ * handler can call the #GstCairoOverlay::report-damage action signal with the
+ * bounding box of what it drew. Only that part of the surface is then put
+ * into the overlay rectangle, cleared again and blended with the video. When
+ * the overlay did not change since the previous frame, the draw handler can
+ * call #GstCairoOverlay::keep-previous instead of drawing, and the previous
+ * overlay rectangle is used again.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -96,6 +104,7 @@
 #include <gst/video/video.h>
 
 #include <cairo.h>
+#include <string.h>
 
 /* RGB16 is native-endianness in GStreamer */
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
@@ -136,9 +145,14 @@ enum
 {
   SIGNAL_DRAW,
   SIGNAL_CAPS_CHANGED,
+  SIGNAL_REPORT_DAMAGE,
+  SIGNAL_KEEP_PREVIOUS,
   N_SIGNALS
 };
 
+/* maximum number of unused surfaces kept around for reuse */
+#define MAX_FREE_SURFACES 4
+
 static guint gst_cairo_overlay_signals[N_SIGNALS];
 
 static void
@@ -215,6 +229,186 @@ gst_cairo_overlay_query (GstBaseTransform * trans, GstPadDirection direction,
   }
 }
 
+/* Pool of transparent ARGB32 surfaces of the video size. The pixels of a
+ * surface are wrapped in the overlay rectangle and the surface goes back to
+ * the pool when the rectangle is freed, which can happen from any thread and
+ * after the element is gone. */
+struct _GstCairoSurfacePool
+{
+  gint refcount;
+  GMutex lock;
+  gint width;
+  gint height;
+  GQueue surfaces;
+};
+
+typedef struct
+{
+  GstCairoSurfacePool *pool;
+  cairo_surface_t *surface;
+  /* area of the surface that was drawn on and must be cleared before the
+   * surface is used again */
+  GstVideoRectangle dirty;
+} GstCairoPoolSurface;
+
+static void
+gst_cairo_pool_surface_free (GstCairoPoolSurface * ps)
+{
+  cairo_surface_destroy (ps->surface);
+  g_free (ps);
+}
+
+static GstCairoSurfacePool *
+gst_cairo_surface_pool_new (gint width, gint height)
+{
+  GstCairoSurfacePool *pool = g_new0 (GstCairoSurfacePool, 1);
+
+  pool->refcount = 1;
+  g_mutex_init (&pool->lock);
+  pool->width = width;
+  pool->height = height;
+  g_queue_init (&pool->surfaces);
+
+  return pool;
+}
+
+static GstCairoSurfacePool *
+gst_cairo_surface_pool_ref (GstCairoSurfacePool * pool)
+{
+  g_atomic_int_inc (&pool->refcount);
+  return pool;
+}
+
+static void
+gst_cairo_surface_pool_unref (GstCairoSurfacePool * pool)
+{
+  if (g_atomic_int_dec_and_test (&pool->refcount)) {
+    g_queue_clear_full (&pool->surfaces,
+        (GDestroyNotify) gst_cairo_pool_surface_free);
+    g_mutex_clear (&pool->lock);
+    g_free (pool);
+  }
+}
+
+/* Get a transparent surface, only the dirty area of a recycled surface has
+ * to be cleared as the rest of it was never drawn on */
+static GstCairoPoolSurface *
+gst_cairo_surface_pool_acquire (GstCairoSurfacePool * pool)
+{
+  GstCairoPoolSurface *ps;
+
+  g_mutex_lock (&pool->lock);
+  ps = g_queue_pop_head (&pool->surfaces);
+  g_mutex_unlock (&pool->lock);
+
+  if (ps == NULL) {
+    cairo_surface_t *surface;
+
+    /* new image surfaces are cleared by cairo */
+    surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, pool->width,
+        pool->height);
+    if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS) {
+      cairo_surface_destroy (surface);
+      return NULL;
+    }
+
+    ps = g_new0 (GstCairoPoolSurface, 1);
+    ps->surface = surface;
+  } else if (ps->dirty.w > 0 && ps->dirty.h > 0) {
+    guint8 *data;
+    gint stride, i;
+
+    cairo_surface_flush (ps->surface);
+    data = cairo_image_surface_get_data (ps->surface);
+    stride = cairo_image_surface_get_stride (ps->surface);
+    data += ps->dirty.y * stride + ps->dirty.x * 4;
+
+    for (i = 0; i < ps->dirty.h; i++) {
+      memset (data, 0, ps->dirty.w * 4);
+      data += stride;
+    }
+    cairo_surface_mark_dirty_rectangle (ps->surface, ps->dirty.x,
+        ps->dirty.y, ps->dirty.w, ps->dirty.h);
+  }
+
+  ps->dirty.x = ps->dirty.y = ps->dirty.w = ps->dirty.h = 0;
+  ps->pool = gst_cairo_surface_pool_ref (pool);
+
+  return ps;
+}
+
+static void
+gst_cairo_surface_pool_release (GstCairoPoolSurface * ps)
+{
+  GstCairoSurfacePool *pool = ps->pool;
+
+  ps->pool = NULL;
+
+  g_mutex_lock (&pool->lock);
+  if (g_queue_get_length (&pool->surfaces) < MAX_FREE_SURFACES) {
+    g_queue_push_tail (&pool->surfaces, ps);
+    ps = NULL;
+  }
+  g_mutex_unlock (&pool->lock);
+
+  if (ps)
+    gst_cairo_pool_surface_free (ps);
+
+  gst_cairo_surface_pool_unref (pool);
+}
+
+static void
+gst_cairo_overlay_report_damage (GstCairoOverlay * overlay, gint x, gint y,
+    gint width, gint height)
+{
+  GstVideoRectangle *damage = &overlay->damage;
+  gint x1, y1, x2, y2;
+
+  /* clip to the frame */
+  x1 = CLAMP (x, 0, GST_VIDEO_INFO_WIDTH (&overlay->info));
+  y1 = CLAMP (y, 0, GST_VIDEO_INFO_HEIGHT (&overlay->info));
+  x2 = CLAMP ((gint64) x + MAX (width, 0), 0,
+      GST_VIDEO_INFO_WIDTH (&overlay->info));
+  y2 = CLAMP ((gint64) y + MAX (height, 0), 0,
+      GST_VIDEO_INFO_HEIGHT (&overlay->info));
+
+  GST_LOG_OBJECT (overlay, "damage %d,%d %dx%d", x1, y1, x2 - x1, y2 - y1);
+
+  overlay->have_damage = TRUE;
+
+  if (x2 <= x1 || y2 <= y1)
+    return;
+
+  /* combine with what was reported before */
+  if (damage->w > 0 && damage->h > 0) {
+    x1 = MIN (x1, damage->x);
+    y1 = MIN (y1, damage->y);
+    x2 = MAX (x2, damage->x + damage->w);
+    y2 = MAX (y2, damage->y + damage->h);
+  }
+
+  damage->x = x1;
+  damage->y = y1;
+  damage->w = x2 - x1;
+  damage->h = y2 - y1;
+}
+
+static void
+gst_cairo_overlay_keep_previous (GstCairoOverlay * overlay)
+{
+  GST_LOG_OBJECT (overlay, "keeping previous overlay");
+  overlay->keep_previous = TRUE;
+}
+
+static void
+gst_cairo_overlay_clear_last_rect (GstCairoOverlay * overlay)
+{
+  if (overlay->last_rect)
+    gst_video_overlay_rectangle_unref (overlay->last_rect);
+  overlay->last_rect = NULL;
+  overlay->have_last_rect = FALSE;
+}
+
 static gboolean
 gst_cairo_overlay_set_caps (GstBaseTransform * trans, GstCaps * in_caps,
     GstCaps * out_caps)
@@ -224,6 +418,20 @@ gst_cairo_overlay_set_caps (GstBaseTransform * trans, GstCaps * in_caps,
   if (!gst_video_info_from_caps (&overlay->info, in_caps))
     return FALSE;
 
+  gst_cairo_overlay_clear_last_rect (overlay);
+
+  if (overlay->surface_pool &&
+      (overlay->surface_pool->width != GST_VIDEO_INFO_WIDTH (&overlay->info) ||
+          overlay->surface_pool->height !=
+          GST_VIDEO_INFO_HEIGHT (&overlay->info))) {
+    gst_cairo_surface_pool_unref (overlay->surface_pool);
+    overlay->surface_pool = NULL;
+  }
+  if (overlay->surface_pool == NULL)
+    overlay->surface_pool =
+        gst_cairo_surface_pool_new (GST_VIDEO_INFO_WIDTH (&overlay->info),
+        GST_VIDEO_INFO_HEIGHT (&overlay->info));
+
   g_signal_emit (overlay, gst_cairo_overlay_signals[SIGNAL_CAPS_CHANGED], 0,
       in_caps, NULL);
 
@@ -379,6 +587,7 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
   GstCairoOverlay *overlay = GST_CAIRO_OVERLAY (trans);
   GstVideoFrame frame;
+  GstCairoPoolSurface *pool_surface = NULL;
   cairo_surface_t *surface;
   cairo_t *cr;
   cairo_format_t format;
@@ -414,11 +623,11 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
   }
 
   if (draw_on_transparent_surface) {
-    surface =
-        cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-        GST_VIDEO_INFO_WIDTH (&overlay->info),
-        GST_VIDEO_INFO_HEIGHT (&overlay->info));
+    pool_surface = gst_cairo_surface_pool_acquire (overlay->surface_pool);
+    surface = pool_surface ? pool_surface->surface : NULL;
   } else {
+    gst_cairo_overlay_clear_last_rect (overlay);
+
     if (format == CAIRO_FORMAT_ARGB32)
       gst_video_overlay_rectangle_premultiply (&frame);
 
@@ -429,15 +638,27 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
             0));
   }
 
-  if (G_UNLIKELY (!surface))
+  if (G_UNLIKELY (!surface)) {
+    GST_WARNING_OBJECT (overlay, "Failed to create surface");
+    if (frame.buffer)
+      gst_video_frame_unmap (&frame);
     return GST_FLOW_ERROR;
+  }
 
   cr = cairo_create (surface);
   if (G_UNLIKELY (!cr)) {
-    cairo_surface_destroy (surface);
+    if (pool_surface)
+      gst_cairo_surface_pool_release (pool_surface);
+    else
+      cairo_surface_destroy (surface);
     return GST_FLOW_ERROR;
   }
 
+  overlay->damage.x = overlay->damage.y = 0;
+  overlay->damage.w = overlay->damage.h = 0;
+  overlay->have_damage = FALSE;
+  overlay->keep_previous = FALSE;
+
   g_signal_emit (overlay, gst_cairo_overlay_signals[SIGNAL_DRAW], 0,
       cr, GST_BUFFER_PTS (buf), GST_BUFFER_DURATION (buf), NULL);
 
@@ -448,32 +669,61 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
     GstBuffer *surface_buffer;
     GstVideoOverlayRectangle *rect;
     GstVideoOverlayComposition *composition;
+    GstVideoRectangle *damage = &overlay->damage;
     gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
     gint stride[GST_VIDEO_MAX_PLANES] = { 0, };
 
-    size =
-        cairo_image_surface_get_height (surface) *
-        cairo_image_surface_get_stride (surface);
-    stride[0] = cairo_image_surface_get_stride (surface);
-
-    /* Create a GstVideoOverlayComposition for blending, this handles
-     * pre-multiplied alpha correctly */
-    surface_buffer =
-        gst_buffer_new_wrapped_full (0, cairo_image_surface_get_data (surface),
-        size, 0, size, surface, (GDestroyNotify) cairo_surface_destroy);
-    gst_buffer_add_video_meta_full (surface_buffer, GST_VIDEO_FRAME_FLAG_NONE,
-        (G_BYTE_ORDER ==
-            G_LITTLE_ENDIAN ? GST_VIDEO_FORMAT_BGRA : GST_VIDEO_FORMAT_ARGB),
-        GST_VIDEO_INFO_WIDTH (&overlay->info),
-        GST_VIDEO_INFO_HEIGHT (&overlay->info), 1, offset, stride);
-    rect =
-        gst_video_overlay_rectangle_new_raw (surface_buffer, 0, 0,
-        GST_VIDEO_INFO_WIDTH (&overlay->info),
-        GST_VIDEO_INFO_HEIGHT (&overlay->info),
-        GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
-    gst_buffer_unref (surface_buffer);
-
-    if (overlay->attach_compo_to_buffer) {
+    /* without a report the whole surface might have been drawn on, unless
+     * the previous overlay is kept instead of drawing */
+    if (!overlay->have_damage && !overlay->keep_previous) {
+      damage->x = damage->y = 0;
+      damage->w = GST_VIDEO_INFO_WIDTH (&overlay->info);
+      damage->h = GST_VIDEO_INFO_HEIGHT (&overlay->info);
+    }
+    /* only this has to be cleared when the surface is recycled */
+    pool_surface->dirty = *damage;
+
+    cairo_surface_flush (surface);
+
+    if (overlay->keep_previous && overlay->have_last_rect) {
+      gst_cairo_surface_pool_release (pool_surface);
+      rect = overlay->last_rect ?
+          gst_video_overlay_rectangle_ref (overlay->last_rect) : NULL;
+    } else if (damage->w == 0 || damage->h == 0) {
+      /* nothing drawn, nothing to blend */
+      gst_cairo_surface_pool_release (pool_surface);
+      rect = NULL;
+    } else {
+      size =
+          cairo_image_surface_get_height (surface) *
+          cairo_image_surface_get_stride (surface);
+      stride[0] = cairo_image_surface_get_stride (surface);
+      offset[0] = damage->y * stride[0] + damage->x * 4;
+
+      /* Create a GstVideoOverlayComposition for blending, this handles
+       * pre-multiplied alpha correctly. Only the damaged part of the
+       * surface is described by the video meta. */
+      surface_buffer =
+          gst_buffer_new_wrapped_full (0,
+          cairo_image_surface_get_data (surface), size, 0, size, pool_surface,
+          (GDestroyNotify) gst_cairo_surface_pool_release);
+      gst_buffer_add_video_meta_full (surface_buffer,
+          GST_VIDEO_FRAME_FLAG_NONE,
+          (G_BYTE_ORDER ==
+              G_LITTLE_ENDIAN ? GST_VIDEO_FORMAT_BGRA : GST_VIDEO_FORMAT_ARGB),
+          damage->w, damage->h, 1, offset, stride);
+      rect =
+          gst_video_overlay_rectangle_new_raw (surface_buffer, damage->x,
+          damage->y, damage->w, damage->h,
+          GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED_ALPHA);
+      gst_buffer_unref (surface_buffer);
+    }
+
+    gst_cairo_overlay_clear_last_rect (overlay);
+    overlay->last_rect = rect ? gst_video_overlay_rectangle_ref (rect) : NULL;
+    overlay->have_last_rect = TRUE;
+
+    if (rect && overlay->attach_compo_to_buffer) {
       GstVideoOverlayCompositionMeta *composition_meta;
 
       composition_meta = gst_buffer_get_video_overlay_composition_meta (buf);
@@ -490,7 +740,7 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
         gst_buffer_add_video_overlay_composition_meta (buf, composition);
         gst_video_overlay_composition_unref (composition);
       }
-    } else {
+    } else if (rect) {
       composition = gst_video_overlay_composition_new (rect);
       gst_video_overlay_rectangle_unref (rect);
       gst_video_overlay_composition_blend (composition, &frame);
@@ -509,6 +759,19 @@ gst_cairo_overlay_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
   return GST_FLOW_OK;
 }
 
+static void
+gst_cairo_overlay_finalize (GObject * object)
+{
+  GstCairoOverlay *overlay = GST_CAIRO_OVERLAY (object);
+
+  gst_cairo_overlay_clear_last_rect (overlay);
+  if (overlay->surface_pool)
+    gst_cairo_surface_pool_unref (overlay->surface_pool);
+  overlay->surface_pool = NULL;
+
+  G_OBJECT_CLASS (gst_cairo_overlay_parent_class)->finalize (object);
+}
+
 static void
 gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
 {
@@ -526,6 +789,7 @@ gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
 
   gobject_class->set_property = gst_cairo_overlay_set_property;
   gobject_class->get_property = gst_cairo_overlay_get_property;
+  gobject_class->finalize = gst_cairo_overlay_finalize;
 
   g_object_class_install_property (gobject_class,
       PROP_DRAW_ON_TRANSPARENT_SURFACE,
@@ -564,6 +828,45 @@ gst_cairo_overlay_class_init (GstCairoOverlayClass * klass)
       G_TYPE_FROM_CLASS (klass),
       0, 0, NULL, NULL, NULL, G_TYPE_NONE, 1, GST_TYPE_CAPS);
 
+  /**
+   * GstCairoOverlay::report-damage:
+   * @overlay: Overlay element emitting the signal.
+   * @x: X coordinate of the drawn area.
+   * @y: Y coordinate of the drawn area.
+   * @width: Width of the drawn area.
+   * @height: Height of the drawn area.
+   *
+   * Action signal to report the area the draw handler drew into when
+   * #GstCairoOverlay:draw-on-transparent-surface is enabled. Only that area is
+   * put into the overlay rectangle. Can be called multiple times from the
+   * draw handler, the bounding box of all areas is used. An empty area means
+   * that nothing was drawn. Without a report the whole surface is used.
+   *
+   * Since: 1.20
+   */
+  gst_cairo_overlay_signals[SIGNAL_REPORT_DAMAGE] =
+      g_signal_new_class_handler ("report-damage",
+      G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_cairo_overlay_report_damage), NULL, NULL, NULL,
+      G_TYPE_NONE, 4, G_TYPE_INT, G_TYPE_INT, G_TYPE_INT, G_TYPE_INT);
+
+  /**
+   * GstCairoOverlay::keep-previous:
+   * @overlay: Overlay element emitting the signal.
+   *
+   * Action signal to call from the draw handler instead of drawing when the
+   * overlay did not change since the previous frame. The overlay of the
+   * previous frame is then used again. Only used when
+   * #GstCairoOverlay:draw-on-transparent-surface is enabled.
+   *
+   * Since: 1.20
+   */
+  gst_cairo_overlay_signals[SIGNAL_KEEP_PREVIOUS] =
+      g_signal_new_class_handler ("keep-previous",
+      G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_cairo_overlay_keep_previous), NULL, NULL, NULL,
+      G_TYPE_NONE, 0);
+
   gst_element_class_set_static_metadata (element_class, "Cairo overlay",
       "Filter/Editor/Video",
       "Render overlay on a video stream using Cairo",
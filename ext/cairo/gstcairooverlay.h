@@ -28,6 +28,8 @@
 
 G_BEGIN_DECLS
 
+typedef struct _GstCairoSurfacePool GstCairoSurfacePool;
+
 #define GST_TYPE_CAIRO_OVERLAY (gst_cairo_overlay_get_type())
 G_DECLARE_FINAL_TYPE (GstCairoOverlay, gst_cairo_overlay,
     GST, CAIRO_OVERLAY, GstBaseTransform)
@@ -41,6 +43,18 @@ struct _GstCairoOverlay {
   /* state */
   GstVideoInfo info;
   gboolean attach_compo_to_buffer;
+
+  /* transparent surfaces to draw on, recycled once downstream is done
+   * with the overlay rectangle */
+  GstCairoSurfacePool *surface_pool;
+  /* rectangle of the previous frame, NULL if nothing was drawn */
+  GstVideoOverlayRectangle *last_rect;
+  gboolean have_last_rect;
+
+  /* reported by the draw handler through the action signals */
+  GstVideoRectangle damage;
+  gboolean have_damage;
+  gboolean keep_previous;
 };
 
 GST_ELEMENT_REGISTER_DECLARE (cairooverlay);
@@ -29,6 +29,12 @@
  * property. Setting this property to a value N > 1 will only decode every
  * Nth frame.
  *
+ * DV frames are independent of each other, so with #GstDVDec:max-threads set
+ * to a value other than 1 a batch of up to that many frames is decoded
+ * concurrently, each with its own libdv decoder, and pushed in the original
+ * order afterwards. This increases the latency by the batch size, which is
+ * reported in the latency query.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 filesrc location=test.dv ! dvdemux name=demux ! dvdec ! xvimagesink
@@ -71,6 +77,7 @@
 
 #define DV_DEFAULT_QUALITY DV_QUALITY_BEST
 #define DV_DEFAULT_DECODE_NTH 1
+#define DV_DEFAULT_MAX_THREADS 1
 
 GST_DEBUG_CATEGORY_STATIC (dvdec_debug);
 #define GST_CAT_DEFAULT dvdec_debug
@@ -81,7 +88,8 @@ enum
   PROP_CLAMP_LUMA,
   PROP_CLAMP_CHROMA,
   PROP_QUALITY,
-  PROP_DECODE_NTH
+  PROP_DECODE_NTH,
+  PROP_MAX_THREADS
 };
 
 const gint qualities[] = {
@@ -139,6 +147,8 @@ static GstFlowReturn gst_dvdec_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 static gboolean gst_dvdec_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_dvdec_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
 
 static GstStateChangeReturn gst_dvdec_change_state (GstElement * element,
     GstStateChange transition);
@@ -147,6 +157,10 @@ static void gst_dvdec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_dvdec_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_dvdec_finalize (GObject * object);
+
+static GstFlowReturn gst_dvdec_drain (GstDVDec * dvdec);
+static void gst_dvdec_discard (GstDVDec * dvdec);
 
 static void
 gst_dvdec_class_init (GstDVDecClass * klass)
@@ -159,6 +173,7 @@ gst_dvdec_class_init (GstDVDecClass * klass)
 
   gobject_class->set_property = gst_dvdec_set_property;
   gobject_class->get_property = gst_dvdec_get_property;
+  gobject_class->finalize = gst_dvdec_finalize;
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_CLAMP_LUMA,
       g_param_spec_boolean ("clamp-luma", "Clamp luma", "Clamp luma",
@@ -175,6 +190,20 @@ gst_dvdec_class_init (GstDVDecClass * klass)
           1, G_MAXINT, DV_DEFAULT_DECODE_NTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDVDec:max-threads:
+   *
+   * Maximum number of frames to decode concurrently, 0 means one per
+   * processor. Only takes effect when going from READY to PAUSED.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_MAX_THREADS,
+      g_param_spec_int ("max-threads", "Maximum threads",
+          "Maximum number of frames decoded in parallel (0 = automatic)",
+          0, G_MAXINT, DV_DEFAULT_MAX_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_dvdec_change_state);
 
   gst_element_class_add_static_pad_template (gstelement_class, &sink_temp);
@@ -200,6 +229,7 @@ gst_dvdec_init (GstDVDec * dvdec)
 
   dvdec->srcpad = gst_pad_new_from_static_template (&src_temp, "src");
   gst_pad_use_fixed_caps (dvdec->srcpad);
+  gst_pad_set_query_function (dvdec->srcpad, gst_dvdec_src_query);
   gst_element_add_pad (GST_ELEMENT (dvdec), dvdec->srcpad);
 
   dvdec->framerate_numerator = 0;
@@ -210,6 +240,122 @@ gst_dvdec_init (GstDVDec * dvdec)
   dvdec->clamp_luma = FALSE;
   dvdec->clamp_chroma = FALSE;
   dvdec->quality = DV_DEFAULT_QUALITY;
+  dvdec->max_threads = DV_DEFAULT_MAX_THREADS;
+
+  g_mutex_init (&dvdec->decode_lock);
+  g_cond_init (&dvdec->decode_cond);
+}
+
+static void
+gst_dvdec_finalize (GObject * object)
+{
+  GstDVDec *dvdec = GST_DVDEC (object);
+
+  g_mutex_clear (&dvdec->decode_lock);
+  g_cond_clear (&dvdec->decode_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/* one frame waiting to be decoded by one of the decoders */
+typedef struct
+{
+  GstBuffer *inbuf;
+  GstMapInfo map;
+  GstBuffer *outbuf;
+  GstVideoFrame frame;
+  guint8 *outframe_ptrs[3];
+  gint outframe_pitches[3];
+  dv_decoder_t *decoder;
+} GstDVDecFrame;
+
+static void
+gst_dvdec_frame_decode (GstDVDecFrame * f)
+{
+  /* every decoder needs to see the header of the frame it decodes */
+  dv_parse_header (f->decoder, f->map.data);
+  dv_decode_full_frame (f->decoder, f->map.data,
+      e_dv_color_yuv, f->outframe_ptrs, f->outframe_pitches);
+}
+
+static void
+gst_dvdec_frame_free (GstDVDecFrame * f, gboolean drop_output)
+{
+  gst_video_frame_unmap (&f->frame);
+  gst_buffer_unmap (f->inbuf, &f->map);
+  gst_buffer_unref (f->inbuf);
+  if (drop_output)
+    gst_buffer_unref (f->outbuf);
+  g_slice_free (GstDVDecFrame, f);
+}
+
+static void
+gst_dvdec_decode_func (gpointer data, gpointer user_data)
+{
+  GstDVDec *dvdec = user_data;
+
+  gst_dvdec_frame_decode (data);
+
+  g_mutex_lock (&dvdec->decode_lock);
+  if (--dvdec->decode_pending == 0)
+    g_cond_signal (&dvdec->decode_cond);
+  g_mutex_unlock (&dvdec->decode_lock);
+}
+
+/* decode all pending frames in parallel and push them in order */
+static GstFlowReturn
+gst_dvdec_drain (GstDVDec * dvdec)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  if (dvdec->pending == NULL || dvdec->pending->len == 0)
+    return GST_FLOW_OK;
+
+  len = dvdec->pending->len;
+  GST_DEBUG_OBJECT (dvdec, "decoding %u frames", len);
+
+  /* hand out all but the last frame, which we decode ourselves */
+  dvdec->decode_pending = len - 1;
+  for (i = 0; i < len - 1; i++)
+    g_thread_pool_push (dvdec->decode_pool,
+        g_ptr_array_index (dvdec->pending, i), NULL);
+
+  gst_dvdec_frame_decode (g_ptr_array_index (dvdec->pending, len - 1));
+
+  g_mutex_lock (&dvdec->decode_lock);
+  while (dvdec->decode_pending > 0)
+    g_cond_wait (&dvdec->decode_cond, &dvdec->decode_lock);
+  g_mutex_unlock (&dvdec->decode_lock);
+
+  for (i = 0; i < len; i++) {
+    GstDVDecFrame *f = g_ptr_array_index (dvdec->pending, i);
+    GstBuffer *outbuf = f->outbuf;
+
+    gst_dvdec_frame_free (f, FALSE);
+
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (dvdec->srcpad, outbuf);
+    else
+      gst_buffer_unref (outbuf);
+  }
+  g_ptr_array_set_size (dvdec->pending, 0);
+
+  return ret;
+}
+
+/* drop pending frames without decoding them */
+static void
+gst_dvdec_discard (GstDVDec * dvdec)
+{
+  guint i;
+
+  if (dvdec->pending == NULL)
+    return;
+
+  for (i = 0; i < dvdec->pending->len; i++)
+    gst_dvdec_frame_free (g_ptr_array_index (dvdec->pending, i), TRUE);
+  g_ptr_array_set_size (dvdec->pending, 0);
 }
 
 static gboolean
@@ -280,6 +426,14 @@ gst_dvdec_negotiate_pool (GstDVDec * dec, GstCaps * caps, GstVideoInfo * info)
     pool = gst_video_buffer_pool_new ();
   }
 
+  /* a batch of frames decoded in parallel holds on to its output buffers
+   * until it is pushed */
+  if (dec->n_threads > 1) {
+    min += dec->n_threads;
+    if (max != 0)
+      max += dec->n_threads;
+  }
+
   if (dec->pool) {
     gst_buffer_pool_set_active (dec->pool, FALSE);
     gst_object_unref (dec->pool);
@@ -296,7 +450,18 @@ gst_dvdec_negotiate_pool (GstDVDec * dec, GstCaps * caps, GstVideoInfo * info)
     gst_buffer_pool_config_add_option (config,
         GST_BUFFER_POOL_OPTION_VIDEO_META);
   }
-  gst_buffer_pool_set_config (pool, config);
+
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    /* the downstream pool can't hold the additional buffers, use our own */
+    GST_DEBUG_OBJECT (dec, "pool rejected the config, using our own pool");
+    gst_object_unref (pool);
+    pool = gst_video_buffer_pool_new ();
+    dec->pool = pool;
+
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, size, min, max);
+    gst_buffer_pool_set_config (pool, config);
+  }
 
   /* and activate */
   gst_buffer_pool_set_active (pool, TRUE);
@@ -367,8 +532,29 @@ gst_dvdec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   dvdec = GST_DVDEC (parent);
 
+  /* frames queued for parallel decoding go out before anything that is
+   * serialized with the data flow */
+  if (GST_EVENT_IS_SERIALIZED (event)
+      && GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP) {
+    GstFlowReturn ret;
+
+    ret = gst_dvdec_drain (dvdec);
+    if (ret != GST_FLOW_OK) {
+      GST_WARNING_OBJECT (dvdec, "failed to push queued frames: %s",
+          gst_flow_get_name (ret));
+      if (GST_EVENT_TYPE (event) != GST_EVENT_EOS) {
+        gst_event_unref (event);
+        return FALSE;
+      }
+      /* the frames before EOS are lost, let the application know */
+      if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS)
+        GST_ELEMENT_FLOW_ERROR (dvdec, ret);
+    }
+  }
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_STOP:
+      gst_dvdec_discard (dvdec);
       gst_segment_init (&dvdec->segment, GST_FORMAT_UNDEFINED);
       dvdec->need_segment = FALSE;
       break;
@@ -411,6 +597,46 @@ gst_dvdec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+static gboolean
+gst_dvdec_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstDVDec *dvdec = GST_DVDEC (parent);
+  gboolean res;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    {
+      GstClockTime min, max, latency;
+      gboolean live;
+
+      if (!(res = gst_pad_peer_query (dvdec->sinkpad, query)))
+        break;
+
+      /* the first frame of a batch waits for the rest of the batch to
+       * arrive and to be decoded */
+      if (dvdec->n_threads > 1 && dvdec->framerate_numerator > 0) {
+        gst_query_parse_latency (query, &live, &min, &max);
+
+        latency = gst_util_uint64_scale_int (dvdec->n_threads * GST_SECOND,
+            dvdec->framerate_denominator, dvdec->framerate_numerator);
+        GST_DEBUG_OBJECT (dvdec, "adding %" GST_TIME_FORMAT " of latency",
+            GST_TIME_ARGS (latency));
+
+        min += latency;
+        if (GST_CLOCK_TIME_IS_VALID (max))
+          max += latency;
+        gst_query_set_latency (query, live, min, max);
+      }
+      break;
+    }
+    default:
+      res = gst_pad_query_default (pad, parent, query);
+      break;
+  }
+
+  return res;
+}
+
 static GstFlowReturn
 gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -475,6 +701,11 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   /* negotiate if not done yet */
   if (!dvdec->src_negotiated) {
+    /* push out the frames decoded with the old format first */
+    ret = gst_dvdec_drain (dvdec);
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      goto done;
+
     if (!gst_dvdec_src_negotiate (dvdec))
       goto not_negotiated;
   }
@@ -482,6 +713,13 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   if (gst_pad_check_reconfigure (dvdec->srcpad)) {
     GstCaps *caps;
 
+    /* the queued frames still use buffers from the current pool */
+    ret = gst_dvdec_drain (dvdec);
+    if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+      gst_pad_mark_reconfigure (dvdec->srcpad);
+      goto done;
+    }
+
     caps = gst_pad_get_current_caps (dvdec->srcpad);
     if (!caps)
       goto flushing;
@@ -513,12 +751,6 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     outframe_pitches[2] = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 2);
   }
 
-  GST_DEBUG_OBJECT (dvdec, "decoding and pushing buffer");
-  dv_decode_full_frame (dvdec->decoder, inframe,
-      e_dv_color_yuv, outframe_ptrs, outframe_pitches);
-
-  gst_video_frame_unmap (&frame);
-
   GST_BUFFER_FLAG_UNSET (outbuf, GST_VIDEO_BUFFER_FLAG_TFF);
 
   GST_BUFFER_OFFSET (outbuf) = GST_BUFFER_OFFSET (buf);
@@ -533,6 +765,35 @@ gst_dvdec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       GST_BUFFER_DURATION (outbuf) = cstop - cstart;
   }
 
+  if (dvdec->n_threads > 1) {
+    GstDVDecFrame *f = g_slice_new (GstDVDecFrame);
+
+    if (!gst_buffer_map (buf, &f->map, GST_MAP_READ)) {
+      g_slice_free (GstDVDecFrame, f);
+      gst_video_frame_unmap (&frame);
+      gst_buffer_unref (outbuf);
+      goto map_failed;
+    }
+    f->inbuf = gst_buffer_ref (buf);
+    f->outbuf = outbuf;
+    f->frame = frame;
+    memcpy (f->outframe_ptrs, outframe_ptrs, sizeof (outframe_ptrs));
+    memcpy (f->outframe_pitches, outframe_pitches, sizeof (outframe_pitches));
+    f->decoder = dvdec->decoders[dvdec->pending->len];
+    g_ptr_array_add (dvdec->pending, f);
+
+    GST_DEBUG_OBJECT (dvdec, "queued frame, %u pending", dvdec->pending->len);
+    if (dvdec->pending->len == dvdec->n_threads)
+      ret = gst_dvdec_drain (dvdec);
+    goto skip;
+  }
+
+  GST_DEBUG_OBJECT (dvdec, "decoding and pushing buffer");
+  dv_decode_full_frame (dvdec->decoder, inframe,
+      e_dv_color_yuv, outframe_ptrs, outframe_pitches);
+
+  gst_video_frame_unmap (&frame);
+
   ret = gst_pad_push (dvdec->srcpad, outbuf);
 
 skip:
@@ -552,6 +813,13 @@ wrong_size:
     ret = GST_FLOW_ERROR;
     goto done;
   }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (dvdec, RESOURCE, READ,
+        (NULL), ("Failed to map input buffer"));
+    ret = GST_FLOW_ERROR;
+    goto done;
+  }
 parse_header_error:
   {
     GST_ELEMENT_ERROR (dvdec, STREAM, DECODE,
@@ -608,6 +876,26 @@ gst_dvdec_change_state (GstElement * element, GstStateChange transition)
       dvdec->src_negotiated = FALSE;
       dvdec->sink_negotiated = FALSE;
       dvdec->need_segment = FALSE;
+
+      dvdec->n_threads = dvdec->max_threads;
+      if (dvdec->n_threads == 0)
+        dvdec->n_threads = g_get_num_processors ();
+      if (dvdec->n_threads > 1) {
+        guint i;
+
+        GST_DEBUG_OBJECT (dvdec, "decoding %u frames in parallel",
+            dvdec->n_threads);
+        dvdec->decoders = g_new (dv_decoder_t *, dvdec->n_threads);
+        for (i = 0; i < dvdec->n_threads; i++) {
+          dvdec->decoders[i] =
+              dv_decoder_new (0, dvdec->clamp_luma, dvdec->clamp_chroma);
+          dvdec->decoders[i]->quality = qualities[dvdec->quality];
+          dv_set_error_log (dvdec->decoders[i], NULL);
+        }
+        dvdec->pending = g_ptr_array_new ();
+        dvdec->decode_pool = g_thread_pool_new (gst_dvdec_decode_func, dvdec,
+            dvdec->n_threads - 1, FALSE, NULL);
+      }
       /* 
        * Enable this function call when libdv2 0.100 or higher is more
        * common
@@ -628,6 +916,24 @@ gst_dvdec_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       dv_decoder_free (dvdec->decoder);
       dvdec->decoder = NULL;
+      if (dvdec->decode_pool) {
+        g_thread_pool_free (dvdec->decode_pool, FALSE, TRUE);
+        dvdec->decode_pool = NULL;
+      }
+      if (dvdec->pending) {
+        gst_dvdec_discard (dvdec);
+        g_ptr_array_free (dvdec->pending, TRUE);
+        dvdec->pending = NULL;
+      }
+      if (dvdec->decoders) {
+        guint i;
+
+        for (i = 0; i < dvdec->n_threads; i++)
+          dv_decoder_free (dvdec->decoders[i]);
+        g_free (dvdec->decoders);
+        dvdec->decoders = NULL;
+      }
+      dvdec->n_threads = 0;
       if (dvdec->pool) {
         gst_buffer_pool_set_active (dvdec->pool, FALSE);
         gst_object_unref (dvdec->pool);
@@ -663,6 +969,9 @@ gst_dvdec_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_DECODE_NTH:
       dvdec->drop_factor = g_value_get_int (value);
       break;
+    case PROP_MAX_THREADS:
+      dvdec->max_threads = g_value_get_int (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -688,6 +997,9 @@ gst_dvdec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DECODE_NTH:
       g_value_set_int (value, dvdec->drop_factor);
       break;
+    case PROP_MAX_THREADS:
+      g_value_set_int (value, dvdec->max_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -68,6 +68,16 @@ struct _GstDVDec {
   GstBufferPool *pool;
   GstSegment     segment;
   gboolean       need_segment;
+
+  /* frame-parallel decoding */
+  gint           max_threads;
+  guint          n_threads;
+  dv_decoder_t **decoders;
+  GThreadPool   *decode_pool;
+  GPtrArray     *pending;
+  GMutex         decode_lock;
+  GCond          decode_cond;
+  guint          decode_pending;
 };
 
 G_END_DECLS
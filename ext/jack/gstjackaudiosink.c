@@ -64,6 +64,7 @@
 
 #include "gstjackaudiosink.h"
 #include "gstjackringbuffer.h"
+#include "gstjackutil.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_jack_audio_sink_debug);
 #define GST_CAT_DEFAULT gst_jack_audio_sink_debug
@@ -191,8 +192,7 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
   GstAudioRingBuffer *buf;
   gint readseg, len;
   guint8 *readptr;
-  gint i, j, flen, channels;
-  sample_t *data;
+  gint i, flen, channels;
 
   buf = GST_AUDIO_RING_BUFFER_CAST (arg);
   sink = GST_JACK_AUDIO_SINK (GST_OBJECT_PARENT (buf));
@@ -212,17 +212,13 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
     if (nframes * sizeof (sample_t) != flen)
       goto wrong_size;
 
-    GST_DEBUG_OBJECT (sink, "copy %d frames: %p, %d bytes, %d channels",
+    GST_LOG_OBJECT (sink, "copy %d frames: %p, %d bytes, %d channels",
         nframes, readptr, flen, channels);
-    data = (sample_t *) readptr;
 
     /* the samples in the ringbuffer have the channels interleaved, we need to
      * deinterleave into the jack target buffers */
-    for (i = 0; i < nframes; i++) {
-      for (j = 0; j < channels; j++) {
-        sink->buffers[j][i] = *data++;
-      }
-    }
+    gst_jack_deinterleave (sink->buffers, (const sample_t *) readptr,
+        channels, nframes);
 
     /* clear written samples in the ringbuffer */
     gst_audio_ring_buffer_clear (buf, readseg);
@@ -230,7 +226,7 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
     /* we wrote one segment */
     gst_audio_ring_buffer_advance (buf, 1);
   } else {
-    GST_DEBUG_OBJECT (sink, "write %d frames silence", nframes);
+    GST_LOG_OBJECT (sink, "write %d frames silence", nframes);
     /* We are not allowed to read from the ringbuffer, write silence to all
      * jack output buffers */
     for (i = 0; i < channels; i++) {
@@ -209,8 +209,7 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
   gint len;
   guint8 *writeptr;
   gint writeseg;
-  gint channels, i, j, flen;
-  sample_t *data;
+  gint channels, i, flen;
 
   buf = GST_AUDIO_RING_BUFFER_CAST (arg);
   src = GST_JACK_AUDIO_SRC (GST_OBJECT_PARENT (buf));
@@ -231,13 +230,11 @@ jack_process_cb (jack_nframes_t nframes, void *arg)
 
     /* the samples in the jack input buffers have to be interleaved into the
      * ringbuffer */
-    data = (sample_t *) writeptr;
-    for (i = 0; i < nframes; ++i)
-      for (j = 0; j < channels; ++j)
-        *data++ = src->buffers[j][i];
+    gst_jack_interleave ((sample_t *) writeptr, src->buffers, channels,
+        nframes);
 
-    GST_DEBUG ("copy %d frames: %p, %d bytes, %d channels", nframes, writeptr,
-        len / channels, channels);
+    GST_LOG_OBJECT (src, "copy %d frames: %p, %d bytes, %d channels",
+        nframes, writeptr, len / channels, channels);
 
     /* we wrote one segment */
     gst_audio_ring_buffer_advance (buf, 1);
@@ -19,6 +19,7 @@
 
 #include "gstjackutil.h"
 #include <gst/audio/audio.h>
+#include <string.h>
 
 static const GstAudioChannelPosition default_positions[8][8] = {
   /* 1 channel */
@@ -108,3 +109,75 @@ gst_jack_set_layout (GstAudioRingBuffer * buffer, GstAudioRingBufferSpec * spec)
   gst_caps_unref (spec->caps);
   spec->caps = gst_audio_info_to_caps (&spec->info);
 }
+
+/* Copy @nframes interleaved frames from @src into the @channels port buffers
+ * in @dest. This runs in the jack process callback, so it must not allocate
+ * or take locks. We walk one channel at a time so that every port buffer is
+ * written sequentially, which keeps the stores contiguous and lets the
+ * compiler vectorise the inner loop; with many ports one period of
+ * interleaved input easily fits in the L1 cache, so the strided reads are
+ * cheap. */
+void
+gst_jack_deinterleave (gfloat ** dest, const gfloat * src, guint channels,
+    guint nframes)
+{
+  guint i, j;
+
+  if (channels == 1) {
+    memcpy (dest[0], src, nframes * sizeof (gfloat));
+    return;
+  }
+
+  if (channels == 2) {
+    gfloat *l = dest[0];
+    gfloat *r = dest[1];
+
+    for (i = 0; i < nframes; i++) {
+      l[i] = src[2 * i];
+      r[i] = src[2 * i + 1];
+    }
+    return;
+  }
+
+  for (j = 0; j < channels; j++) {
+    gfloat *d = dest[j];
+    const gfloat *s = src + j;
+
+    for (i = 0; i < nframes; i++)
+      d[i] = s[i * channels];
+  }
+}
+
+/* The reverse of gst_jack_deinterleave(): interleave @nframes samples from
+ * each of the @channels port buffers in @src into @dest. Same realtime
+ * constraints apply. */
+void
+gst_jack_interleave (gfloat * dest, gfloat * const *src, guint channels,
+    guint nframes)
+{
+  guint i, j;
+
+  if (channels == 1) {
+    memcpy (dest, src[0], nframes * sizeof (gfloat));
+    return;
+  }
+
+  if (channels == 2) {
+    const gfloat *l = src[0];
+    const gfloat *r = src[1];
+
+    for (i = 0; i < nframes; i++) {
+      dest[2 * i] = l[i];
+      dest[2 * i + 1] = r[i];
+    }
+    return;
+  }
+
+  for (j = 0; j < channels; j++) {
+    const gfloat *s = src[j];
+    gfloat *d = dest + j;
+
+    for (i = 0; i < nframes; i++)
+      d[i * channels] = s[i];
+  }
+}
@@ -28,4 +28,12 @@
 void
 gst_jack_set_layout (GstAudioRingBuffer * buffer, GstAudioRingBufferSpec *spec);
 
+void
+gst_jack_deinterleave (gfloat ** dest, const gfloat * src, guint channels,
+    guint nframes);
+
+void
+gst_jack_interleave (gfloat * dest, gfloat * const * src, guint channels,
+    guint nframes);
+
 #endif  // _GST_JACK_UTIL_H_
@@ -166,7 +166,8 @@ enum
   ARG_CBR,
   ARG_QUALITY,
   ARG_ENCODING_ENGINE_QUALITY,
-  ARG_MONO
+  ARG_MONO,
+  ARG_THREADS
 };
 
 #define DEFAULT_TARGET LAMEMP3ENC_TARGET_QUALITY
@@ -175,6 +176,14 @@ enum
 #define DEFAULT_QUALITY 4
 #define DEFAULT_ENCODING_ENGINE_QUALITY LAMEMP3ENC_ENCODING_ENGINE_QUALITY_STANDARD
 #define DEFAULT_MONO FALSE
+#define DEFAULT_THREADS 1
+
+/* length of the segments encoded in parallel and of their overlap, in
+ * frames. The overlap lets the encoder state settle before the first frame
+ * of a segment that is used, and makes sure the last frames used see the
+ * same input as in a continuous encoding. */
+#define SEGMENT_FRAMES 256
+#define SEGMENT_OVERLAP_FRAMES 4
 
 static gboolean gst_lamemp3enc_start (GstAudioEncoder * enc);
 static gboolean gst_lamemp3enc_stop (GstAudioEncoder * enc);
@@ -188,7 +197,10 @@ static void gst_lamemp3enc_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_lamemp3enc_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
-static gboolean gst_lamemp3enc_setup (GstLameMP3Enc * lame, GstTagList ** tags);
+static lame_global_flags *gst_lamemp3enc_setup (GstLameMP3Enc * lame,
+    gboolean segment, GstTagList ** tags);
+static void gst_lamemp3enc_encode_segment (gpointer data, gpointer user_data);
+static void gst_lamemp3enc_clear_segments (GstLameMP3Enc * lame);
 
 #define gst_lamemp3enc_parent_class parent_class
 #ifdef ENABLE_NLS
@@ -217,7 +229,11 @@ gst_lamemp3enc_release_memory (GstLameMP3Enc * lame)
 static void
 gst_lamemp3enc_finalize (GObject * obj)
 {
-  gst_lamemp3enc_release_memory (GST_LAMEMP3ENC (obj));
+  GstLameMP3Enc *lame = GST_LAMEMP3ENC (obj);
+
+  gst_lamemp3enc_release_memory (lame);
+  g_mutex_clear (&lame->segment_lock);
+  g_cond_clear (&lame->segment_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -285,6 +301,26 @@ gst_lamemp3enc_class_init (GstLameMP3EncClass * klass)
       g_param_spec_boolean ("mono", "Mono", "Enforce mono encoding",
           DEFAULT_MONO,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstLameMP3Enc:threads:
+   *
+   * Number of threads to encode with. When not 1, the input is split into
+   * segments of a few seconds that are encoded by independent encoders in
+   * parallel and joined at frame boundaries. Neighbouring segments overlap
+   * by a few frames so the frames at the joins match a continuous encoding,
+   * and the bit reservoir is not used so that the frames of the overlap can
+   * be dropped.
+   *
+   * This adds a latency of several seconds and is only used for non-live
+   * input that is not resampled by the encoder.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Number of threads to encode segments in parallel with "
+          "(0 = automatic, 1 = no parallel encoding)", 0, 64, DEFAULT_THREADS,
+          G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_type_mark_as_plugin_api (GST_TYPE_LAMEMP3ENC_TARGET, 0);
   gst_type_mark_as_plugin_api (GST_TYPE_LAMEMP3ENC_ENCODING_ENGINE_QUALITY, 0);
@@ -294,6 +330,10 @@ static void
 gst_lamemp3enc_init (GstLameMP3Enc * lame)
 {
   GST_PAD_SET_ACCEPT_TEMPLATE (GST_AUDIO_ENCODER_SINK_PAD (lame));
+
+  g_mutex_init (&lame->segment_lock);
+  g_cond_init (&lame->segment_cond);
+  g_queue_init (&lame->segments);
 }
 
 static gboolean
@@ -307,6 +347,11 @@ gst_lamemp3enc_start (GstAudioEncoder * enc)
     lame->adapter = gst_adapter_new ();
   gst_adapter_clear (lame->adapter);
 
+  if (!lame->pcm_adapter)
+    lame->pcm_adapter = gst_adapter_new ();
+  gst_adapter_clear (lame->pcm_adapter);
+  lame->first_segment = TRUE;
+
   return TRUE;
 }
 
@@ -322,10 +367,35 @@ gst_lamemp3enc_stop (GstAudioEncoder * enc)
     lame->adapter = NULL;
   }
 
+  gst_lamemp3enc_clear_segments (lame);
+  if (lame->segment_pool) {
+    g_thread_pool_free (lame->segment_pool, FALSE, TRUE);
+    lame->segment_pool = NULL;
+  }
+  if (lame->pcm_adapter) {
+    g_object_unref (lame->pcm_adapter);
+    lame->pcm_adapter = NULL;
+  }
+  lame->parallel = FALSE;
+
   gst_lamemp3enc_release_memory (lame);
   return TRUE;
 }
 
+static gboolean
+gst_lamemp3enc_upstream_is_live (GstLameMP3Enc * lame)
+{
+  GstQuery *query;
+  gboolean live = FALSE;
+
+  query = gst_query_new_latency ();
+  if (gst_pad_peer_query (GST_AUDIO_ENCODER_SINK_PAD (lame), query))
+    gst_query_parse_latency (query, &live, NULL, NULL);
+  gst_query_unref (query);
+
+  return live;
+}
+
 static gboolean
 gst_lamemp3enc_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
 {
@@ -346,7 +416,8 @@ gst_lamemp3enc_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
   gst_lamemp3enc_release_memory (lame);
 
   GST_DEBUG_OBJECT (lame, "setting up lame");
-  if (!gst_lamemp3enc_setup (lame, &tags))
+  lame->lgf = gst_lamemp3enc_setup (lame, FALSE, &tags);
+  if (lame->lgf == NULL)
     goto setup_failed;
 
   out_samplerate = lame_get_out_samplerate (lame->lgf);
@@ -384,7 +455,38 @@ gst_lamemp3enc_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
    * - report latency */
   latency = gst_util_uint64_scale_int (lame_get_framesize (lame->lgf),
       GST_SECOND, lame->samplerate);
-  gst_audio_encoder_set_latency (enc, latency, latency);
+
+  lame->parallel = FALSE;
+  if (lame->threads != 1) {
+    if (out_samplerate != lame->samplerate) {
+      GST_WARNING_OBJECT (lame, "not encoding in parallel when resampling");
+    } else if (gst_lamemp3enc_upstream_is_live (lame)) {
+      GST_WARNING_OBJECT (lame, "not encoding live input in parallel");
+    } else {
+      lame->parallel = TRUE;
+    }
+  }
+
+  if (lame->parallel) {
+    lame->n_threads = lame->threads ? lame->threads : g_get_num_processors ();
+    GST_DEBUG_OBJECT (lame, "encoding segments with %u threads",
+        lame->n_threads);
+
+    if (lame->segment_pool == NULL)
+      lame->segment_pool = g_thread_pool_new (gst_lamemp3enc_encode_segment,
+          lame, lame->n_threads, FALSE, NULL);
+    else
+      g_thread_pool_set_max_threads (lame->segment_pool, lame->n_threads,
+          NULL);
+    lame->first_segment = TRUE;
+
+    /* a segment and its overlap have to be collected before encoding */
+    latency *= SEGMENT_FRAMES + 2 * SEGMENT_OVERLAP_FRAMES;
+    gst_audio_encoder_set_latency (enc, latency,
+        latency * (2 * lame->n_threads + 1));
+  } else {
+    gst_audio_encoder_set_latency (enc, latency, latency);
+  }
 
   if (tags) {
     gst_audio_encoder_merge_tags (enc, tags, GST_TAG_MERGE_REPLACE);
@@ -473,6 +575,9 @@ gst_lamemp3enc_set_property (GObject * object, guint prop_id,
     case ARG_MONO:
       lame->mono = g_value_get_boolean (value);
       break;
+    case ARG_THREADS:
+      lame->threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -506,6 +611,9 @@ gst_lamemp3enc_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_MONO:
       g_value_set_boolean (value, lame->mono);
       break;
+    case ARG_THREADS:
+      g_value_set_uint (value, lame->threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -764,10 +872,291 @@ gst_lamemp3enc_flush_full (GstLameMP3Enc * lame, gboolean push)
   return result;
 }
 
+/* A segment of the input, encoded by its own encoder in a thread of the
+ * segment pool. All but the first segment start with the overlap of the
+ * previous one, and all but the last segment end with the overlap of the
+ * next one. */
+typedef struct
+{
+  lame_global_flags *lgf;
+  GstBuffer *pcm;
+  /* frames encoded from the leading overlap */
+  guint skip_frames;
+  /* frames to keep after that, 0 keeps all frames of the last segment */
+  guint n_frames;
+
+  GstBuffer *mp3;
+  gboolean failed;
+  gboolean done;
+} GstLameMP3EncSegment;
+
+static void
+gst_lamemp3enc_segment_free (GstLameMP3EncSegment * seg)
+{
+  if (seg->lgf)
+    lame_close (seg->lgf);
+  if (seg->pcm)
+    gst_buffer_unref (seg->pcm);
+  if (seg->mp3)
+    gst_buffer_unref (seg->mp3);
+  g_free (seg);
+}
+
+static void
+gst_lamemp3enc_encode_segment (gpointer data, gpointer user_data)
+{
+  GstLameMP3EncSegment *seg = data;
+  GstLameMP3Enc *lame = user_data;
+  gint mp3_buffer_size, mp3_size, flush_size;
+  gint num_samples;
+  GstMapInfo in_map, mp3_map;
+  gsize offset, start;
+  guint frame;
+  gboolean flushing;
+
+  g_mutex_lock (&lame->segment_lock);
+  flushing = lame->segments_flushing;
+  g_mutex_unlock (&lame->segment_lock);
+
+  if (flushing)
+    goto done;
+
+  gst_buffer_map (seg->pcm, &in_map, GST_MAP_READ);
+
+  num_samples = in_map.size / 2;
+
+  /* room for the encoded segment and the final frames */
+  mp3_buffer_size = 1.25 * num_samples + 2 * 7200;
+  seg->mp3 = gst_buffer_new_allocate (NULL, mp3_buffer_size, NULL);
+  gst_buffer_map (seg->mp3, &mp3_map, GST_MAP_WRITE);
+
+  if (lame->num_channels == 1) {
+    mp3_size = lame_encode_buffer (seg->lgf,
+        (short int *) in_map.data,
+        (short int *) in_map.data, num_samples, mp3_map.data, mp3_buffer_size);
+  } else {
+    mp3_size = lame_encode_buffer_interleaved (seg->lgf,
+        (short int *) in_map.data,
+        num_samples / lame->num_channels, mp3_map.data, mp3_buffer_size);
+  }
+  gst_buffer_unmap (seg->pcm, &in_map);
+
+  if (mp3_size >= 0) {
+    flush_size = lame_encode_flush (seg->lgf, mp3_map.data + mp3_size,
+        mp3_buffer_size - mp3_size);
+    mp3_size = flush_size >= 0 ? mp3_size + flush_size : flush_size;
+  }
+
+  /* with the bit reservoir disabled every frame is self-contained, so only
+   * the frames that belong to this segment are kept */
+  offset = start = 0;
+  frame = 0;
+  while (mp3_size > 0 && offset + 4 <= (gsize) mp3_size) {
+    guint32 header = GST_READ_UINT32_BE (mp3_map.data + offset);
+
+    if (!mp3_sync_check (lame, header)) {
+      mp3_size = -1;
+      break;
+    }
+
+    if (frame == seg->skip_frames)
+      start = offset;
+    offset += mp3_type_frame_length_from_header (lame, header, NULL, NULL,
+        NULL, NULL, NULL, NULL, NULL);
+    frame++;
+
+    if (seg->n_frames && frame == seg->skip_frames + seg->n_frames)
+      break;
+  }
+  gst_buffer_unmap (seg->mp3, &mp3_map);
+
+  if (mp3_size < 0) {
+    GST_WARNING_OBJECT (lame, "failed to encode segment (%d)", mp3_size);
+    seg->failed = TRUE;
+  } else if (frame <= seg->skip_frames) {
+    gst_buffer_unref (seg->mp3);
+    seg->mp3 = NULL;
+  } else {
+    if (seg->n_frames && frame < seg->skip_frames + seg->n_frames)
+      GST_WARNING_OBJECT (lame, "segment is missing %u frames",
+          seg->skip_frames + seg->n_frames - frame);
+    gst_buffer_resize (seg->mp3, start,
+        MIN (offset, (gsize) mp3_size) - start);
+  }
+
+done:
+  lame_close (seg->lgf);
+  seg->lgf = NULL;
+  gst_buffer_unref (seg->pcm);
+  seg->pcm = NULL;
+
+  g_mutex_lock (&lame->segment_lock);
+  seg->done = TRUE;
+  g_cond_broadcast (&lame->segment_cond);
+  g_mutex_unlock (&lame->segment_lock);
+}
+
+/* hand the next segment of the input to the segment pool, the last segment
+ * takes all remaining input */
+static gboolean
+gst_lamemp3enc_queue_segment (GstLameMP3Enc * lame, gboolean last)
+{
+  GstLameMP3EncSegment *seg;
+  GstTagList *tags = NULL;
+  gsize frame_bytes, lead, size;
+
+  frame_bytes = lame_get_framesize (lame->lgf) * lame->num_channels * 2;
+  lead = lame->first_segment ? 0 : SEGMENT_OVERLAP_FRAMES * frame_bytes;
+
+  if (last)
+    size = gst_adapter_available (lame->pcm_adapter);
+  else
+    size = lead + (SEGMENT_FRAMES + SEGMENT_OVERLAP_FRAMES) * frame_bytes;
+
+  seg = g_new0 (GstLameMP3EncSegment, 1);
+  seg->lgf = gst_lamemp3enc_setup (lame, TRUE, &tags);
+  if (tags)
+    gst_tag_list_unref (tags);
+  if (seg->lgf == NULL) {
+    g_free (seg);
+    return FALSE;
+  }
+
+  seg->skip_frames = lead / frame_bytes;
+  seg->n_frames = last ? 0 : SEGMENT_FRAMES;
+  seg->pcm = gst_adapter_get_buffer (lame->pcm_adapter, size);
+
+  /* keep the overlap with the next segment */
+  if (last)
+    gst_adapter_clear (lame->pcm_adapter);
+  else
+    gst_adapter_flush (lame->pcm_adapter,
+        size - 2 * SEGMENT_OVERLAP_FRAMES * frame_bytes);
+  lame->first_segment = FALSE;
+
+  GST_LOG_OBJECT (lame, "queueing segment of %" G_GSIZE_FORMAT " bytes, "
+      "skipping %u frames", size, seg->skip_frames);
+
+  g_mutex_lock (&lame->segment_lock);
+  g_queue_push_tail (&lame->segments, seg);
+  g_mutex_unlock (&lame->segment_lock);
+
+  g_thread_pool_push (lame->segment_pool, seg, NULL);
+
+  return TRUE;
+}
+
+/* push out encoded segments in order, waiting for them while more than
+ * @max_pending segments are queued */
+static GstFlowReturn
+gst_lamemp3enc_push_segments (GstLameMP3Enc * lame, guint max_pending)
+{
+  GstLameMP3EncSegment *seg;
+  GstFlowReturn result = GST_FLOW_OK;
+
+  g_mutex_lock (&lame->segment_lock);
+  while ((seg = g_queue_peek_head (&lame->segments))) {
+    if (!seg->done) {
+      if (g_queue_get_length (&lame->segments) <= max_pending)
+        break;
+      g_cond_wait (&lame->segment_cond, &lame->segment_lock);
+      continue;
+    }
+    g_queue_pop_head (&lame->segments);
+    g_mutex_unlock (&lame->segment_lock);
+
+    if (seg->failed) {
+      GST_ELEMENT_ERROR (lame, STREAM, ENCODE, (NULL),
+          ("failed to encode segment"));
+      result = GST_FLOW_ERROR;
+    } else if (seg->mp3) {
+      gst_adapter_push (lame->adapter, seg->mp3);
+      seg->mp3 = NULL;
+      result = gst_lamemp3enc_finish_frames (lame);
+    }
+    gst_lamemp3enc_segment_free (seg);
+
+    g_mutex_lock (&lame->segment_lock);
+    if (result != GST_FLOW_OK)
+      break;
+  }
+  g_mutex_unlock (&lame->segment_lock);
+
+  return result;
+}
+
+static void
+gst_lamemp3enc_clear_segments (GstLameMP3Enc * lame)
+{
+  GstLameMP3EncSegment *seg;
+
+  /* segments that did not start yet are skipped by the threads */
+  g_mutex_lock (&lame->segment_lock);
+  lame->segments_flushing = TRUE;
+  while ((seg = g_queue_peek_head (&lame->segments))) {
+    if (!seg->done) {
+      g_cond_wait (&lame->segment_cond, &lame->segment_lock);
+      continue;
+    }
+    g_queue_pop_head (&lame->segments);
+    gst_lamemp3enc_segment_free (seg);
+  }
+  lame->segments_flushing = FALSE;
+  g_mutex_unlock (&lame->segment_lock);
+
+  if (lame->pcm_adapter)
+    gst_adapter_clear (lame->pcm_adapter);
+  lame->first_segment = TRUE;
+}
+
 static void
 gst_lamemp3enc_flush (GstAudioEncoder * enc)
 {
-  gst_lamemp3enc_flush_full (GST_LAMEMP3ENC (enc), FALSE);
+  GstLameMP3Enc *lame = GST_LAMEMP3ENC (enc);
+
+  gst_lamemp3enc_clear_segments (lame);
+  gst_lamemp3enc_flush_full (lame, FALSE);
+}
+
+static GstFlowReturn
+gst_lamemp3enc_handle_frame_parallel (GstLameMP3Enc * lame, GstBuffer * in_buf)
+{
+  GstFlowReturn result;
+  gsize frame_bytes, segment_bytes;
+
+  if (G_UNLIKELY (in_buf == NULL)) {
+    /* the last segment also gets the final frames */
+    if (!lame->first_segment || gst_adapter_available (lame->pcm_adapter)) {
+      if (!gst_lamemp3enc_queue_segment (lame, TRUE))
+        goto setup_failed;
+    }
+    result = gst_lamemp3enc_push_segments (lame, 0);
+    lame->first_segment = TRUE;
+    return result;
+  }
+
+  gst_adapter_push (lame->pcm_adapter, gst_buffer_ref (in_buf));
+
+  frame_bytes = lame_get_framesize (lame->lgf) * lame->num_channels * 2;
+  segment_bytes = (SEGMENT_FRAMES + SEGMENT_OVERLAP_FRAMES) * frame_bytes;
+  if (!lame->first_segment)
+    segment_bytes += SEGMENT_OVERLAP_FRAMES * frame_bytes;
+
+  while (gst_adapter_available (lame->pcm_adapter) >= segment_bytes) {
+    if (!gst_lamemp3enc_queue_segment (lame, FALSE))
+      goto setup_failed;
+    segment_bytes = (SEGMENT_FRAMES + 2 * SEGMENT_OVERLAP_FRAMES) * frame_bytes;
+  }
+
+  /* keep all threads busy, but don't collect unlimited input */
+  return gst_lamemp3enc_push_segments (lame, 2 * lame->n_threads);
+
+setup_failed:
+  {
+    GST_ELEMENT_ERROR (lame, LIBRARY, SETTINGS,
+        (_("Failed to configure LAME mp3 audio encoder. Check your encoding parameters.")), (NULL));
+    return GST_FLOW_ERROR;
+  }
 }
 
 static GstFlowReturn
@@ -782,6 +1171,9 @@ gst_lamemp3enc_handle_frame (GstAudioEncoder * enc, GstBuffer * in_buf)
 
   lame = GST_LAMEMP3ENC (enc);
 
+  if (lame->parallel)
+    return gst_lamemp3enc_handle_frame_parallel (lame, in_buf);
+
   /* squeeze remaining and push */
   if (G_UNLIKELY (in_buf == NULL))
     return gst_lamemp3enc_flush_full (lame, TRUE);
@@ -830,11 +1222,13 @@ gst_lamemp3enc_handle_frame (GstAudioEncoder * enc, GstBuffer * in_buf)
   return result;
 }
 
-/* set up the encoder state */
-static gboolean
-gst_lamemp3enc_setup (GstLameMP3Enc * lame, GstTagList ** tags)
+/* set up an encoder, segment encoders use the output samplerate of the main
+ * encoder and don't use the bit reservoir so they can be cut anywhere */
+static lame_global_flags *
+gst_lamemp3enc_setup (GstLameMP3Enc * lame, gboolean segment,
+    GstTagList ** tags)
 {
-  gboolean res;
+  lame_global_flags *lgf;
 
 #define CHECK_ERROR(command) G_STMT_START {\
   if ((command) < 0) { \
@@ -843,7 +1237,8 @@ gst_lamemp3enc_setup (GstLameMP3Enc * lame, GstTagList ** tags)
       gst_tag_list_unref (*tags); \
       *tags = NULL; \
     } \
-    return FALSE; \
+    lame_close (lgf); \
+    return NULL; \
   } \
 }G_STMT_END
 
@@ -852,15 +1247,15 @@ gst_lamemp3enc_setup (GstLameMP3Enc * lame, GstTagList ** tags)
 
   GST_DEBUG_OBJECT (lame, "starting setup");
 
-  lame->lgf = lame_init ();
+  lgf = lame_init ();
 
-  if (lame->lgf == NULL)
-    return FALSE;
+  if (lgf == NULL)
+    return NULL;
 
   *tags = gst_tag_list_new_empty ();
 
   /* copy the parameters over */
-  lame_set_in_samplerate (lame->lgf, lame->samplerate);
+  lame_set_in_samplerate (lgf, lame->samplerate);
 
   /* let lame choose default samplerate unless outgoing sample rate is fixed */
   allowed_caps = gst_pad_get_allowed_caps (GST_AUDIO_ENCODER_SRC_PAD (lame));
@@ -874,61 +1269,68 @@ gst_lamemp3enc_setup (GstLameMP3Enc * lame, GstTagList ** tags)
     if (gst_structure_get_int (structure, "rate", &samplerate)) {
       GST_DEBUG_OBJECT (lame, "Setting sample rate to %d as fixed in src caps",
           samplerate);
-      lame_set_out_samplerate (lame->lgf, samplerate);
+      lame_set_out_samplerate (lgf, samplerate);
     } else {
       GST_DEBUG_OBJECT (lame, "Letting lame choose sample rate");
-      lame_set_out_samplerate (lame->lgf, 0);
+      lame_set_out_samplerate (lgf, 0);
     }
     gst_caps_unref (allowed_caps);
     allowed_caps = NULL;
   } else {
     GST_DEBUG_OBJECT (lame, "No peer yet, letting lame choose sample rate");
-    lame_set_out_samplerate (lame->lgf, 0);
+    lame_set_out_samplerate (lgf, 0);
   }
 
-  CHECK_ERROR (lame_set_num_channels (lame->lgf, lame->num_channels));
-  CHECK_ERROR (lame_set_bWriteVbrTag (lame->lgf, 0));
+  /* segments have to produce the same output as the main encoder */
+  if (segment)
+    lame_set_out_samplerate (lgf, lame->out_samplerate);
+
+  CHECK_ERROR (lame_set_num_channels (lgf, lame->num_channels));
+  CHECK_ERROR (lame_set_bWriteVbrTag (lgf, 0));
 
   if (lame->target == LAMEMP3ENC_TARGET_QUALITY) {
-    CHECK_ERROR (lame_set_VBR (lame->lgf, vbr_default));
-    CHECK_ERROR (lame_set_VBR_quality (lame->lgf, lame->quality));
+    CHECK_ERROR (lame_set_VBR (lgf, vbr_default));
+    CHECK_ERROR (lame_set_VBR_quality (lgf, lame->quality));
   } else {
     if (lame->cbr) {
       CHECK_AND_FIXUP_BITRATE (lame, "bitrate", lame->bitrate);
-      CHECK_ERROR (lame_set_VBR (lame->lgf, vbr_off));
-      CHECK_ERROR (lame_set_brate (lame->lgf, lame->bitrate));
+      CHECK_ERROR (lame_set_VBR (lgf, vbr_off));
+      CHECK_ERROR (lame_set_brate (lgf, lame->bitrate));
     } else {
-      CHECK_ERROR (lame_set_VBR (lame->lgf, vbr_abr));
-      CHECK_ERROR (lame_set_VBR_mean_bitrate_kbps (lame->lgf, lame->bitrate));
+      CHECK_ERROR (lame_set_VBR (lgf, vbr_abr));
+      CHECK_ERROR (lame_set_VBR_mean_bitrate_kbps (lgf, lame->bitrate));
     }
     gst_tag_list_add (*tags, GST_TAG_MERGE_REPLACE, GST_TAG_BITRATE,
         lame->bitrate * 1000, NULL);
   }
 
   if (lame->encoding_engine_quality == LAMEMP3ENC_ENCODING_ENGINE_QUALITY_FAST)
-    CHECK_ERROR (lame_set_quality (lame->lgf, 7));
+    CHECK_ERROR (lame_set_quality (lgf, 7));
   else if (lame->encoding_engine_quality ==
       LAMEMP3ENC_ENCODING_ENGINE_QUALITY_HIGH)
-    CHECK_ERROR (lame_set_quality (lame->lgf, 2));
+    CHECK_ERROR (lame_set_quality (lgf, 2));
   /* else default */
 
   if (lame->mono)
-    CHECK_ERROR (lame_set_mode (lame->lgf, MONO));
+    CHECK_ERROR (lame_set_mode (lgf, MONO));
+
+  if (segment)
+    CHECK_ERROR (lame_set_disable_reservoir (lgf, 1));
 
   /* initialize the lame encoder */
-  if ((retval = lame_init_params (lame->lgf)) >= 0) {
+  if ((retval = lame_init_params (lgf)) >= 0) {
     /* FIXME: it would be nice to print out the mode here */
     GST_INFO
         ("lame encoder setup (target %s, quality %f, bitrate %d, %d Hz, %d channels)",
         (lame->target == LAMEMP3ENC_TARGET_QUALITY) ? "quality" : "bitrate",
         lame->quality, lame->bitrate, lame->samplerate, lame->num_channels);
-    res = TRUE;
   } else {
     GST_ERROR_OBJECT (lame, "lame_init_params returned %d", retval);
-    res = FALSE;
+    lame_close (lgf);
+    lgf = NULL;
   }
 
   GST_DEBUG_OBJECT (lame, "done with setup");
-  return res;
+  return lgf;
 #undef CHECK_ERROR
 }
@@ -55,10 +55,23 @@ struct _GstLameMP3Enc {
   gfloat quality;
   gint encoding_engine_quality;
   gboolean mono;
+  guint threads;
 
   lame_global_flags *lgf;
 
   GstAdapter *adapter;
+
+  /* parallel encoding of independent segments */
+  gboolean parallel;
+  guint n_threads;
+  GThreadPool *segment_pool;
+  GMutex segment_lock;
+  GCond segment_cond;
+  GQueue segments;
+  gboolean segments_flushing;
+  /* input not handed to a segment yet */
+  GstAdapter *pcm_adapter;
+  gboolean first_segment;
 };
 
 GST_ELEMENT_REGISTER_DECLARE (lamemp3enc);
@@ -1179,6 +1179,17 @@ gst_pulseringbuffer_clear (GstAudioRingBuffer * buf)
   pa_threaded_mainloop_lock (mainloop);
   GST_DEBUG_OBJECT (psink, "clearing");
   if (pbuf->stream) {
+    if (pbuf->m_data) {
+      /* drop the pending data in the shm memory buffer, it must not be
+       * written out after the flush */
+      pa_stream_cancel_write (pbuf->stream);
+
+      pbuf->m_data = NULL;
+      pbuf->m_towrite = 0;
+      pbuf->m_writable = 0;
+      pbuf->m_lastoffset = 0;
+    }
+
     /* don't wait for the flush to complete */
     if ((o = pa_stream_flush (pbuf->stream, NULL, pbuf)))
       pa_operation_unref (o);
@@ -1538,9 +1549,10 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
     if (towrite > buf->spec.segsize)
       towrite = buf->spec.segsize;
 
-    if ((pbuf->m_writable < towrite) || (offset != pbuf->m_lastoffset)) {
-      /* if no room left or discontinuity in offset,
-         we need to flush data and get a new buffer */
+    if ((pbuf->m_data == NULL) || (pbuf->m_writable == 0) ||
+        (offset != pbuf->m_lastoffset)) {
+      /* if there is no shared memory buffer, no room left in it or a
+         discontinuity in offset, we need to flush data and get a new buffer */
 
       /* flush the buffer if possible */
       if ((pbuf->m_data != NULL) && (pbuf->m_towrite > 0)) {
@@ -1554,7 +1566,9 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
           goto write_failed;
         }
       }
+      pbuf->m_data = NULL;
       pbuf->m_towrite = 0;
+      pbuf->m_writable = 0;
       pbuf->m_offset = offset;  /* keep track of current offset */
 
       /* get a buffer to write in for now on */
@@ -1589,10 +1603,14 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
           goto was_paused;
       }
 
-      /* Recalculate what we can write in the next chunk */
+      /* Recalculate what we can write in the next chunk. Always ask for at
+       * least a segment so that commits smaller than a segment are collected
+       * in the same shared memory block and handed to the server with one
+       * write once it is full, instead of one write per commit. Whatever is
+       * left pending is written out on EOS, gap and discontinuities. */
       towrite = out_samples * bpf;
-      if (pbuf->m_writable > towrite)
-        pbuf->m_writable = towrite;
+      if (pbuf->m_writable > MAX (towrite, buf->spec.segsize))
+        pbuf->m_writable = MAX (towrite, buf->spec.segsize);
 
       GST_LOG_OBJECT (psink, "requesting %" G_GSIZE_FORMAT " bytes of "
           "shared memory", pbuf->m_writable);
@@ -1672,6 +1690,7 @@ gst_pulseringbuffer_commit (GstAudioRingBuffer * buf, guint64 * sample,
               pbuf->m_towrite, NULL, pbuf->m_offset, PA_SEEK_ABSOLUTE) < 0) {
         goto write_failed;
       }
+      pbuf->m_data = NULL;
       pbuf->m_towrite = 0;
       pbuf->m_offset = offset + towrite;        /* keep track of current offset */
     }
@@ -1787,8 +1806,10 @@ gst_pulsering_flush (GstPulseRingBuffer * pbuf)
       goto write_failed;
     }
 
-    pbuf->m_towrite = 0;
     pbuf->m_offset += pbuf->m_towrite;  /* keep track of current offset */
+    pbuf->m_data = NULL;
+    pbuf->m_towrite = 0;
+    pbuf->m_writable = 0;
   }
 
 done:
@@ -58,6 +58,14 @@
 GST_DEBUG_CATEGORY_STATIC (gst_wavpack_dec_debug);
 #define GST_CAT_DEFAULT gst_wavpack_dec_debug
 
+#define DEFAULT_THREADS 0
+
+enum
+{
+  PROP_0,
+  PROP_THREADS
+};
+
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -98,6 +106,10 @@ static GstFlowReturn gst_wavpack_dec_handle_frame (GstAudioDecoder * dec,
     GstBuffer * buffer);
 
 static void gst_wavpack_dec_finalize (GObject * object);
+static void gst_wavpack_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_wavpack_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_wavpack_dec_post_tags (GstWavpackDec * dec);
 
 #define gst_wavpack_dec_parent_class parent_class
@@ -125,6 +137,22 @@ gst_wavpack_dec_class_init (GstWavpackDecClass * klass)
       "Sebastian Dröge <slomo@circular-chaos.org>");
 
   gobject_class->finalize = gst_wavpack_dec_finalize;
+  gobject_class->set_property = gst_wavpack_dec_set_property;
+  gobject_class->get_property = gst_wavpack_dec_get_property;
+
+  /**
+   * GstWavpackDec:threads:
+   *
+   * Number of threads used for decoding the blocks of a frame. 0 uses as
+   * many threads as there are CPUs. This has no effect if the library
+   * was built without multithreading support.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Number of decoding threads (0 = automatic)", 0, 16,
+          DEFAULT_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   base_class->start = GST_DEBUG_FUNCPTR (gst_wavpack_dec_start);
   base_class->stop = GST_DEBUG_FUNCPTR (gst_wavpack_dec_stop);
@@ -150,6 +178,7 @@ gst_wavpack_dec_init (GstWavpackDec * dec)
 {
   dec->context = NULL;
   dec->stream_reader = gst_wavpack_stream_reader_new ();
+  dec->threads = DEFAULT_THREADS;
 
   gst_audio_decoder_set_needs_format (GST_AUDIO_DECODER (dec), TRUE);
   gst_audio_decoder_set_use_default_pad_acceptcaps (GST_AUDIO_DECODER_CAST
@@ -170,6 +199,38 @@ gst_wavpack_dec_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_wavpack_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstWavpackDec *dec = GST_WAVPACK_DEC (object);
+
+  switch (prop_id) {
+    case PROP_THREADS:
+      dec->threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_wavpack_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstWavpackDec *dec = GST_WAVPACK_DEC (object);
+
+  switch (prop_id) {
+    case PROP_THREADS:
+      g_value_set_uint (value, dec->threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_wavpack_dec_start (GstAudioDecoder * dec)
 {
@@ -325,9 +386,27 @@ gst_wavpack_dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buf)
    * the new one has the same caps */
   if (!dec->context) {
     gchar error_msg[80];
+    gint flags = OPEN_STREAMING;
+
+#ifdef HAVE_WAVPACK_THREADS
+    {
+      guint threads = dec->threads;
+
+      if (threads == 0)
+        threads = g_get_num_processors ();
+
+      /* the library counts the worker threads in addition to the
+       * calling thread */
+      if (threads > 1) {
+        flags |= (MIN (threads - 1, OPEN_THREADS_MASK >> OPEN_THREADS_SHFT)
+            << OPEN_THREADS_SHFT) & OPEN_THREADS_MASK;
+        GST_DEBUG_OBJECT (dec, "decoding with %u threads", threads);
+      }
+    }
+#endif
 
     dec->context = WavpackOpenFileInputEx (dec->stream_reader,
-        &dec->wv_id, NULL, error_msg, OPEN_STREAMING, 0);
+        &dec->wv_id, NULL, error_msg, flags, 0);
 
     /* expect this to work */
     if (!dec->context) {
@@ -56,6 +56,8 @@ struct _GstWavpackDec
 
   gint channel_reorder_map[64];
 
+  guint threads;
+
 };
 
 gboolean gst_wavpack_dec_plugin_init (GstPlugin * plugin);
@@ -82,7 +82,8 @@ enum
   ARG_CORRECTION_MODE,
   ARG_MD5,
   ARG_EXTRA_PROCESSING,
-  ARG_JOINT_STEREO_MODE
+  ARG_JOINT_STEREO_MODE,
+  ARG_THREADS
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_wavpack_enc_debug);
@@ -271,6 +272,20 @@ gst_wavpack_enc_class_init (GstWavpackEncClass * klass)
           GST_WAVPACK_JS_MODE_AUTO,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWavpackEnc:threads:
+   *
+   * Number of threads used for encoding the blocks of a frame. 0 uses as
+   * many threads as there are CPUs. This has no effect if the library
+   * was built without multithreading support.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, ARG_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Number of encoding threads (0 = automatic)", 0, 16, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_type_mark_as_plugin_api (GST_TYPE_WAVPACK_ENC_MODE, 0);
   gst_type_mark_as_plugin_api (GST_TYPE_WAVPACK_ENC_CORRECTION_MODE, 0);
   gst_type_mark_as_plugin_api (GST_TYPE_WAVPACK_ENC_JOINT_STEREO_MODE, 0);
@@ -350,6 +365,7 @@ gst_wavpack_enc_init (GstWavpackEnc * enc)
   enc->md5 = FALSE;
   enc->extra_processing = 0;
   enc->joint_stereo_mode = GST_WAVPACK_JS_MODE_AUTO;
+  enc->threads = 0;
 
   /* require perfect ts */
   gst_audio_encoder_set_perfect_timestamp (benc, TRUE);
@@ -549,6 +565,18 @@ gst_wavpack_enc_set_wp_config (GstWavpackEnc * enc)
       enc->wp_config->flags |= (CONFIG_JOINT_OVERRIDE | CONFIG_JOINT_STEREO);
       break;
   }
+
+#ifdef HAVE_WAVPACK_THREADS
+  /* Worker threads, in addition to the streaming thread */
+  {
+    guint threads = enc->threads;
+
+    if (threads == 0)
+      threads = g_get_num_processors ();
+    enc->wp_config->worker_threads = MIN (threads, 16) - 1;
+    GST_DEBUG_OBJECT (enc, "encoding with %u threads", threads);
+  }
+#endif
 }
 
 static int
@@ -954,6 +982,9 @@ gst_wavpack_enc_set_property (GObject * object, guint prop_id,
     case ARG_JOINT_STEREO_MODE:
       enc->joint_stereo_mode = g_value_get_enum (value);
       break;
+    case ARG_THREADS:
+      enc->threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -996,6 +1027,9 @@ gst_wavpack_enc_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_JOINT_STEREO_MODE:
       g_value_set_enum (value, enc->joint_stereo_mode);
       break;
+    case ARG_THREADS:
+      g_value_set_uint (value, enc->threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -71,6 +71,7 @@ struct _GstWavpackEnc
   GChecksum *md5_context;
   guint extra_processing;
   guint joint_stereo_mode;
+  guint threads;
 
   void *first_block;
   int32_t first_block_size;
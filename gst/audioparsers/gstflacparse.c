@@ -149,10 +149,50 @@ static const guint16 crc16_table[256] = {
   0x8213, 0x0216, 0x021c, 0x8219, 0x0208, 0x820d, 0x8207, 0x0202
 };
 
+/* Tables for slicing-by-8: crc16_slice_table[k][b] is the CRC of byte b
+ * followed by k zero bytes, row 0 being crc16_table */
+static guint16 crc16_slice_table[8][256];
+
+static gpointer
+gst_flac_init_crc16_slice_table (gpointer user_data)
+{
+  guint i, k;
+
+  for (i = 0; i < 256; i++)
+    crc16_slice_table[0][i] = crc16_table[i];
+
+  for (k = 1; k < 8; k++) {
+    for (i = 0; i < 256; i++) {
+      guint16 prev = crc16_slice_table[k - 1][i];
+
+      crc16_slice_table[k][i] = (prev << 8) ^ crc16_table[prev >> 8];
+    }
+  }
+
+  return NULL;
+}
+
+/* Continues a CRC-16 calculation started with @crc = 0 */
 static guint16
-gst_flac_calculate_crc16 (const guint8 * data, guint length)
+gst_flac_update_crc16 (guint16 crc, const guint8 * data, guint length)
 {
-  guint16 crc = 0;
+  static GOnce table_once = G_ONCE_INIT;
+
+  g_once (&table_once, gst_flac_init_crc16_slice_table, NULL);
+
+  /* process 8 bytes per iteration, the current CRC only affects the
+   * first two of them */
+  while (length >= 8) {
+    crc = crc16_slice_table[7][data[0] ^ (crc >> 8)] ^
+        crc16_slice_table[6][data[1] ^ (crc & 0xff)] ^
+        crc16_slice_table[5][data[2]] ^
+        crc16_slice_table[4][data[3]] ^
+        crc16_slice_table[3][data[4]] ^
+        crc16_slice_table[2][data[5]] ^
+        crc16_slice_table[1][data[6]] ^ crc16_slice_table[0][data[7]];
+    data += 8;
+    length -= 8;
+  }
 
   while (length--) {
     crc = ((crc << 8) ^ crc16_table[(crc >> 8) ^ *data]) & 0xffff;
@@ -657,6 +697,8 @@ gst_flac_parse_frame_is_valid (GstFlacParse * flacparse,
   FrameHeaderCheckReturn header_ret;
   guint16 block_size;
   gboolean suspect_start = FALSE, suspect_end = FALSE;
+  guint16 crc = 0;
+  guint crc_len = 0;
 
   if (size < flacparse->min_framesize)
     goto need_more;
@@ -693,9 +735,15 @@ gst_flac_parse_frame_is_valid (GstFlacParse * flacparse,
         remaining, FALSE, NULL, &suspect_end);
     if (header_ret == FRAME_HEADER_VALID) {
       if (flacparse->check_frame_checksums || suspect_start || suspect_end) {
-        guint16 actual_crc = gst_flac_calculate_crc16 (data, i - 2);
+        guint16 actual_crc;
         guint16 expected_crc = GST_READ_UINT16_BE (data + i - 2);
 
+        /* candidates only move forward, so continue the CRC from where the
+         * previous candidate left off instead of starting over */
+        crc = gst_flac_update_crc16 (crc, data + crc_len, i - 2 - crc_len);
+        crc_len = i - 2;
+        actual_crc = crc;
+
         GST_LOG_OBJECT (flacparse,
             "Found possible frame (%d, %d). Checking for CRC match",
             suspect_start, suspect_end);
@@ -717,7 +765,8 @@ gst_flac_parse_frame_is_valid (GstFlacParse * flacparse,
   /* For the last frame output everything to the end */
   if (G_UNLIKELY (GST_BASE_PARSE_DRAINING (flacparse))) {
     if (flacparse->check_frame_checksums) {
-      guint16 actual_crc = gst_flac_calculate_crc16 (data, size - 2);
+      guint16 actual_crc =
+          gst_flac_update_crc16 (crc, data + crc_len, size - 2 - crc_len);
       guint16 expected_crc = GST_READ_UINT16_BE (data + size - 2);
 
       if (actual_crc == expected_crc) {
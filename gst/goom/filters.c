@@ -105,17 +105,131 @@ getPixelRGB_ (Pixel * buffer, Uint x, Color * c)
 /* faire : a / sqrtperte <=> a >> PERTEDEC */
 #define PERTEDEC 4
 
-/* pure c version of the zoom filter */
+/* pure c version of the zoom filter, renders the output pixels in
+ * [start, end) */
 static void c_zoom (Pixel * expix1, Pixel * expix2, unsigned int prevX,
     unsigned int prevY, signed int *brutS, signed int *brutD, int buffratio,
-    int precalCoef[BUFFPOINTNB][BUFFPOINTNB]);
+    int precalCoef[BUFFPOINTNB][BUFFPOINTNB], int start, int end);
 
-/* simple wrapper to give it the same proto than the others */
+/* below this frame size splitting the zoom into stripes costs more than it
+ * gains */
+#define ZOOM_STRIPE_MIN_PIXELS (640 * 480)
+
+typedef struct _ZOOM_STRIPE_SYNC
+{
+  GMutex lock;
+  GCond cond;
+  int pending;
+} ZoomStripeSync;
+
+typedef struct _ZOOM_STRIPE
+{
+  Pixel *src, *dest;
+  unsigned int sizeX, sizeY;
+  int *brutS, *brutD;
+  int buffratio;
+  int (*precalCoef)[16];
+  int start, end;
+  ZoomStripeSync *sync;
+} ZoomStripe;
+
+static void
+zoom_stripe_func (gpointer data, gpointer user_data)
+{
+  ZoomStripe *stripe = data;
+
+  c_zoom (stripe->src, stripe->dest, stripe->sizeX, stripe->sizeY,
+      stripe->brutS, stripe->brutD, stripe->buffratio, stripe->precalCoef,
+      stripe->start, stripe->end);
+
+  g_mutex_lock (&stripe->sync->lock);
+  if (--stripe->sync->pending == 0)
+    g_cond_signal (&stripe->sync->cond);
+  g_mutex_unlock (&stripe->sync->lock);
+}
+
+/* one pool shared by all instances, NULL on single core machines */
+static GThreadPool *
+zoom_get_stripe_pool (void)
+{
+  static gsize pool = 0;
+
+  if (g_once_init_enter (&pool)) {
+    GThreadPool *p = NULL;
+    guint n_threads = g_get_num_processors ();
+
+    if (n_threads > 1)
+      p = g_thread_pool_new (zoom_stripe_func, NULL, n_threads - 1, FALSE,
+          NULL);
+    g_once_init_leave (&pool, (gsize) p + 1);
+  }
+
+  return (GThreadPool *) (pool - 1);
+}
+
+/* simple wrapper to give it the same proto than the others. Every output
+ * pixel only depends on the source frame and the transformation buffers, so
+ * large frames are split into horizontal stripes that are rendered
+ * concurrently; the result is identical to rendering it in one go. */
 void
 zoom_filter_c (int sizeX, int sizeY, Pixel * src, Pixel * dest, int *brutS,
     int *brutD, int buffratio, int precalCoef[16][16])
 {
-  c_zoom (src, dest, sizeX, sizeY, brutS, brutD, buffratio, precalCoef);
+  GThreadPool *pool;
+  ZoomStripe *stripes;
+  ZoomStripeSync sync;
+  int n_stripes, lines, i;
+
+  /* the corners of the source are used for out of range positions */
+  src[0].val = src[sizeX - 1].val = src[sizeX * sizeY - 1].val =
+      src[sizeX * sizeY - sizeX].val = 0;
+
+  pool = zoom_get_stripe_pool ();
+  if (pool == NULL || sizeX * sizeY < ZOOM_STRIPE_MIN_PIXELS) {
+    c_zoom (src, dest, sizeX, sizeY, brutS, brutD, buffratio, precalCoef, 0,
+        sizeX * sizeY);
+    return;
+  }
+
+  n_stripes = g_thread_pool_get_max_threads (pool) + 1;
+  lines = (sizeY + n_stripes - 1) / n_stripes;
+  n_stripes = (sizeY + lines - 1) / lines;
+  stripes = g_newa (ZoomStripe, n_stripes);
+
+  g_mutex_init (&sync.lock);
+  g_cond_init (&sync.cond);
+  sync.pending = n_stripes - 1;
+
+  for (i = 0; i < n_stripes; i++) {
+    ZoomStripe *stripe = &stripes[i];
+
+    stripe->src = src;
+    stripe->dest = dest;
+    stripe->sizeX = sizeX;
+    stripe->sizeY = sizeY;
+    stripe->brutS = brutS;
+    stripe->brutD = brutD;
+    stripe->buffratio = buffratio;
+    stripe->precalCoef = precalCoef;
+    stripe->start = i * lines * sizeX;
+    stripe->end = MIN ((i + 1) * lines, sizeY) * sizeX;
+    stripe->sync = &sync;
+
+    /* the streaming thread renders the last stripe itself */
+    if (i < n_stripes - 1)
+      g_thread_pool_push (pool, stripe, NULL);
+  }
+
+  c_zoom (src, dest, sizeX, sizeY, brutS, brutD, buffratio, precalCoef,
+      stripes[n_stripes - 1].start, stripes[n_stripes - 1].end);
+
+  g_mutex_lock (&sync.lock);
+  while (sync.pending > 0)
+    g_cond_wait (&sync.cond, &sync.lock);
+  g_mutex_unlock (&sync.lock);
+
+  g_mutex_clear (&sync.lock);
+  g_cond_clear (&sync.cond);
 }
 
 static void generatePrecalCoef (int precalCoef[BUFFPOINTNB][BUFFPOINTNB]);
@@ -443,20 +557,18 @@ makeZoomBufferStripe (ZoomFilterFXWrapperData * data, int INTERLACE_INCR)
 
 static void
 c_zoom (Pixel * expix1, Pixel * expix2, unsigned int prevX, unsigned int prevY,
-    signed int *brutS, signed int *brutD, int buffratio, int precalCoef[16][16])
+    signed int *brutS, signed int *brutD, int buffratio, int precalCoef[16][16],
+    int start, int end)
 {
   int myPos, myPos2;
   Color couleur;
 
   unsigned int ax = (prevX - 1) << PERTEDEC, ay = (prevY - 1) << PERTEDEC;
 
-  int bufsize = prevX * prevY * 2;
+  int bufsize = end * 2;
   int bufwidth = prevX;
 
-  expix1[0].val = expix1[prevX - 1].val = expix1[prevX * prevY - 1].val =
-      expix1[prevX * prevY - prevX].val = 0;
-
-  for (myPos = 0; myPos < bufsize; myPos += 2) {
+  for (myPos = start * 2; myPos < bufsize; myPos += 2) {
     Color col1, col2, col3, col4;
     int c1, c2, c3, c4, px, py;
     int pos;
@@ -88,12 +88,40 @@
 
 #include "atomsrecovery.h"
 
-#define MAX_CHUNK_SIZE (1024 * 1024)    /* 1MB */
+#define MAX_CHUNK_SIZE (4 * 1024 * 1024)        /* 4MB */
+
+/* how often to report progress while copying the media data */
+#define PROGRESS_INTERVAL (256 * 1024 * 1024)
 
 #define ATOMS_RECOV_OUTPUT_WRITE_ERROR(err) \
     g_set_error (err, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_FILE, \
         "Failed to write to output file: %s", g_strerror (errno))
 
+/* fseek()/ftell() only take a long, which is 32 bits on Windows */
+static gboolean
+atoms_recov_fseek (FILE * f, gint64 offset, gint whence)
+{
+#ifdef G_OS_WIN32
+  return _fseeki64 (f, offset, whence) == 0;
+#elif defined (HAVE_FSEEKO) || defined (G_OS_UNIX)
+  return fseeko (f, (off_t) offset, whence) == 0;
+#else
+  return fseek (f, (long) offset, whence) == 0;
+#endif
+}
+
+static gint64
+atoms_recov_ftell (FILE * f)
+{
+#ifdef G_OS_WIN32
+  return _ftelli64 (f);
+#elif defined (HAVE_FSEEKO) || defined (G_OS_UNIX)
+  return ftello (f);
+#else
+  return ftell (f);
+#endif
+}
+
 static gboolean
 atoms_recov_write_version (FILE * f)
 {
@@ -278,7 +306,7 @@ moov_recov_file_parse_prefix (MoovRecovFile * moovrf)
   guint32 fourcc;
   guint32 size;
   guint32 total_size = 0;
-  if (fseek (moovrf->file, 2, SEEK_SET) != 0)
+  if (!atoms_recov_fseek (moovrf->file, 2, SEEK_SET))
     return FALSE;
   if (!read_atom_header (moovrf->file, &fourcc, &size)) {
     return FALSE;
@@ -286,7 +314,7 @@ moov_recov_file_parse_prefix (MoovRecovFile * moovrf)
 
   if (fourcc != FOURCC_ftyp) {
     /* we might have a prefix here */
-    if (fseek (moovrf->file, size - 8, SEEK_CUR) != 0)
+    if (!atoms_recov_fseek (moovrf->file, size - 8, SEEK_CUR))
       return FALSE;
 
     total_size += size;
@@ -301,7 +329,7 @@ moov_recov_file_parse_prefix (MoovRecovFile * moovrf)
     return FALSE;
   total_size += size;
   moovrf->prefix_size = total_size;
-  return fseek (moovrf->file, size - 8, SEEK_CUR) == 0;
+  return atoms_recov_fseek (moovrf->file, size - 8, SEEK_CUR);
 }
 
 static gboolean
@@ -317,10 +345,10 @@ moov_recov_file_parse_mvhd (MoovRecovFile * moovrf)
     return FALSE;
 
   moovrf->mvhd_size = size;
-  moovrf->mvhd_pos = ftell (moovrf->file) - 8;
+  moovrf->mvhd_pos = atoms_recov_ftell (moovrf->file) - 8;
 
   /* skip the remaining of the mvhd in the file */
-  return fseek (moovrf->file, size - 8, SEEK_CUR) == 0;
+  return atoms_recov_fseek (moovrf->file, size - 8, SEEK_CUR);
 }
 
 static gboolean
@@ -338,7 +366,7 @@ mdat_recov_file_parse_mdat_start (MdatRecovFile * mdatrf)
     mdatrf->mdat_header_size = 8;
     mdatrf->mdat_size = 8;
   }
-  mdatrf->mdat_start = ftell (mdatrf->file) - 8;
+  mdatrf->mdat_start = atoms_recov_ftell (mdatrf->file) - 8;
 
   return fourcc == FOURCC_mdat;
 }
@@ -357,7 +385,7 @@ mdat_recov_file_find_mdat (FILE * file, GError ** err)
       case FOURCC_ftyp:
       case FOURCC_free:
       case FOURCC_udta:
-        if (fseek (file, size - 8, SEEK_CUR) != 0) {
+        if (!atoms_recov_fseek (file, size - 8, SEEK_CUR)) {
           goto file_seek_error;
         }
         break;
@@ -373,7 +401,7 @@ mdat_recov_file_find_mdat (FILE * file, GError ** err)
 
   if (!failure) {
     /* Reverse to mdat start */
-    if (fseek (file, -8, SEEK_CUR) != 0)
+    if (!atoms_recov_fseek (file, -8, SEEK_CUR))
       goto file_seek_error;
   }
 
@@ -402,14 +430,14 @@ mdat_recov_file_create (FILE * file, gboolean datafile, GError ** err)
   mrf->rawfile = datafile;
 
   /* get the file/data length */
-  if (fseek (file, 0, SEEK_END) != 0)
+  if (!atoms_recov_fseek (file, 0, SEEK_END))
     goto file_length_error;
   /* still needs to deduce the mdat header and ftyp size */
-  mrf->data_size = ftell (file);
+  mrf->data_size = atoms_recov_ftell (file);
   if (mrf->data_size == -1L)
     goto file_length_error;
 
-  if (fseek (file, 0, SEEK_SET) != 0)
+  if (!atoms_recov_fseek (file, 0, SEEK_SET))
     goto file_seek_error;
 
   if (datafile) {
@@ -487,7 +515,7 @@ skip_atom (MoovRecovFile * moovrf, guint32 expected_fourcc)
   if (fourcc != expected_fourcc)
     return FALSE;
 
-  return (fseek (moovrf->file, size - 8, SEEK_CUR) == 0);
+  return atoms_recov_fseek (moovrf->file, size - 8, SEEK_CUR);
 }
 
 static gboolean
@@ -503,16 +531,16 @@ moov_recov_parse_tkhd (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_tkhd)
     return FALSE;
 
-  trakrd->tkhd_file_offset = ftell (moovrf->file) - 8;
+  trakrd->tkhd_file_offset = atoms_recov_ftell (moovrf->file) - 8;
 
   /* move 8 bytes forward to the trak_id pos */
-  if (fseek (moovrf->file, 12, SEEK_CUR) != 0)
+  if (!atoms_recov_fseek (moovrf->file, 12, SEEK_CUR))
     return FALSE;
   if (fread (data, 1, 4, moovrf->file) != 4)
     return FALSE;
 
   /* advance the rest of tkhd */
-  if (fseek (moovrf->file, 68, SEEK_CUR) != 0)
+  if (!atoms_recov_fseek (moovrf->file, 68, SEEK_CUR))
     return FALSE;
 
   trakrd->trak_id = GST_READ_UINT32_BE (data);
@@ -531,7 +559,7 @@ moov_recov_parse_stbl (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_stbl)
     return FALSE;
 
-  trakrd->stbl_file_offset = ftell (moovrf->file) - 8;
+  trakrd->stbl_file_offset = atoms_recov_ftell (moovrf->file) - 8;
   trakrd->stbl_size = size;
 
   /* skip the stsd */
@@ -539,11 +567,11 @@ moov_recov_parse_stbl (MoovRecovFile * moovrf, TrakRecovData * trakrd)
     return FALSE;
   if (fourcc != FOURCC_stsd)
     return FALSE;
-  if (fseek (moovrf->file, auxsize - 8, SEEK_CUR) != 0)
+  if (!atoms_recov_fseek (moovrf->file, auxsize - 8, SEEK_CUR))
     return FALSE;
 
   trakrd->stsd_size = auxsize;
-  trakrd->post_stsd_offset = ftell (moovrf->file);
+  trakrd->post_stsd_offset = atoms_recov_ftell (moovrf->file);
 
   /* as this is the last atom we parse, we don't skip forward */
 
@@ -562,7 +590,7 @@ moov_recov_parse_minf (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_minf)
     return FALSE;
 
-  trakrd->minf_file_offset = ftell (moovrf->file) - 8;
+  trakrd->minf_file_offset = atoms_recov_ftell (moovrf->file) - 8;
   trakrd->minf_size = size;
 
   /* skip either of vmhd, smhd, hmhd that might follow */
@@ -571,21 +599,21 @@ moov_recov_parse_minf (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_vmhd && fourcc != FOURCC_smhd && fourcc != FOURCC_hmhd &&
       fourcc != FOURCC_gmhd)
     return FALSE;
-  if (fseek (moovrf->file, auxsize - 8, SEEK_CUR))
+  if (!atoms_recov_fseek (moovrf->file, auxsize - 8, SEEK_CUR))
     return FALSE;
 
   /* skip a possible hdlr and the following dinf */
   if (!read_atom_header (moovrf->file, &fourcc, &auxsize))
     return FALSE;
   if (fourcc == FOURCC_hdlr) {
-    if (fseek (moovrf->file, auxsize - 8, SEEK_CUR))
+    if (!atoms_recov_fseek (moovrf->file, auxsize - 8, SEEK_CUR))
       return FALSE;
     if (!read_atom_header (moovrf->file, &fourcc, &auxsize))
       return FALSE;
   }
   if (fourcc != FOURCC_dinf)
     return FALSE;
-  if (fseek (moovrf->file, auxsize - 8, SEEK_CUR))
+  if (!atoms_recov_fseek (moovrf->file, auxsize - 8, SEEK_CUR))
     return FALSE;
 
   /* now we are ready to read the stbl */
@@ -608,15 +636,15 @@ moov_recov_parse_mdhd (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_mdhd)
     return FALSE;
 
-  trakrd->mdhd_file_offset = ftell (moovrf->file) - 8;
+  trakrd->mdhd_file_offset = atoms_recov_ftell (moovrf->file) - 8;
 
   /* get the timescale */
-  if (fseek (moovrf->file, 12, SEEK_CUR) != 0)
+  if (!atoms_recov_fseek (moovrf->file, 12, SEEK_CUR))
     return FALSE;
   if (fread (data, 1, 4, moovrf->file) != 4)
     return FALSE;
   trakrd->timescale = GST_READ_UINT32_BE (data);
-  if (fseek (moovrf->file, 8, SEEK_CUR) != 0)
+  if (!atoms_recov_fseek (moovrf->file, 8, SEEK_CUR))
     return FALSE;
   return TRUE;
 }
@@ -633,7 +661,7 @@ moov_recov_parse_mdia (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (fourcc != FOURCC_mdia)
     return FALSE;
 
-  trakrd->mdia_file_offset = ftell (moovrf->file) - 8;
+  trakrd->mdia_file_offset = atoms_recov_ftell (moovrf->file) - 8;
   trakrd->mdia_size = size;
 
   if (!moov_recov_parse_mdhd (moovrf, trakrd))
@@ -653,7 +681,7 @@ moov_recov_parse_trak (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   guint32 size;
   guint32 fourcc;
 
-  offset = ftell (moovrf->file);
+  offset = atoms_recov_ftell (moovrf->file);
   if (offset == -1) {
     return FALSE;
   }
@@ -677,17 +705,16 @@ moov_recov_parse_trak (MoovRecovFile * moovrf, TrakRecovData * trakrd)
   if (!moov_recov_parse_mdia (moovrf, trakrd))
     return FALSE;
 
-  if (fseek (moovrf->file,
-          (long int) trakrd->mdia_file_offset + trakrd->mdia_size,
-          SEEK_SET) != 0)
+  if (!atoms_recov_fseek (moovrf->file,
+          trakrd->mdia_file_offset + trakrd->mdia_size, SEEK_SET))
     return FALSE;
 
-  trakrd->extra_atoms_offset = ftell (moovrf->file);
+  trakrd->extra_atoms_offset = atoms_recov_ftell (moovrf->file);
   trakrd->extra_atoms_size = size - (trakrd->extra_atoms_offset - offset);
 
   trakrd->file_offset = offset;
   /* position after the trak */
-  return fseek (moovrf->file, (long int) offset + size, SEEK_SET) == 0;
+  return atoms_recov_fseek (moovrf->file, offset + size, SEEK_SET);
 }
 
 MoovRecovFile *
@@ -934,12 +961,12 @@ fail:
 }
 
 static gboolean
-copy_data_from_file_to_file (FILE * from, guint position, guint size, FILE * to,
-    GError ** err)
+copy_data_from_file_to_file (FILE * from, guint64 position, guint size,
+    FILE * to, GError ** err)
 {
   guint8 *data = NULL;
 
-  if (fseek (from, position, SEEK_SET) != 0)
+  if (!atoms_recov_fseek (from, position, SEEK_SET))
     goto fail;
   data = g_malloc (size);
   if (fread (data, 1, size, from) != size) {
@@ -960,7 +987,8 @@ fail:
 
 gboolean
 moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
-    FILE * outf, GError ** err, GError ** warn)
+    FILE * outf, MoovRecovProgressFunc progress, gpointer user_data,
+    GError ** err, GError ** warn)
 {
   guint8 auxdata[16];
   guint8 *data = NULL;
@@ -973,10 +1001,10 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
   guint8 *stbl_children = NULL;
   guint32 longest_duration = 0;
   guint16 version;
-  guint remaining;
+  guint64 remaining, total, next_progress;
 
   /* check the version */
-  if (fseek (moovrf->file, 0, SEEK_SET) != 0) {
+  if (!atoms_recov_fseek (moovrf->file, 0, SEEK_SET)) {
     g_set_error (err, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_FILE,
         "Failed to seek to the start of the moov recovery file");
     goto fail;
@@ -1036,7 +1064,8 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
   for (i = 0; i < moovrf->num_traks; i++) {
     TrakRecovData *trak = &(moovrf->traks_rd[i]);
     /* 8 or 16 for the mdat header */
-    gint64 offset = moov_size + ftell (outf) + mdatrf->mdat_header_size;
+    gint64 offset =
+        moov_size + atoms_recov_ftell (outf) + mdatrf->mdat_header_size;
     atom_stco64_chunks_set_offset (&trak->stbl.stco64, offset);
   }
 
@@ -1050,7 +1079,7 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
 
   /* write the mvhd */
   mvhd_data = g_malloc (moovrf->mvhd_size);
-  if (fseek (moovrf->file, moovrf->mvhd_pos, SEEK_SET) != 0)
+  if (!atoms_recov_fseek (moovrf->file, moovrf->mvhd_pos, SEEK_SET))
     goto fail;
   if (fread (mvhd_data, 1, moovrf->mvhd_size,
           moovrf->file) != moovrf->mvhd_size)
@@ -1095,7 +1124,7 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
     mdia_new_size = trak->mdia_size + size_diff;
     trak_new_size = trak->trak_size + size_diff;
 
-    if (fseek (moovrf->file, trak->file_offset, SEEK_SET) != 0)
+    if (!atoms_recov_fseek (moovrf->file, trak->file_offset, SEEK_SET))
       goto fail;
     trak_data_size = trak->post_stsd_offset - trak->file_offset;
     trak_data = g_malloc (trak_data_size);
@@ -1160,14 +1189,17 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
   }
 
   /* now read the mdat data and output to the file */
-  if (fseek (mdatrf->file, mdatrf->mdat_start +
-          (mdatrf->rawfile ? 0 : mdatrf->mdat_header_size), SEEK_SET) != 0)
+  if (!atoms_recov_fseek (mdatrf->file, mdatrf->mdat_start +
+          (mdatrf->rawfile ? 0 : mdatrf->mdat_header_size), SEEK_SET))
     goto fail;
 
-  remaining = mdatrf->mdat_size - mdatrf->mdat_header_size;
+  total = remaining = mdatrf->mdat_size - mdatrf->mdat_header_size;
+  next_progress = PROGRESS_INTERVAL;
+  if (progress)
+    progress (0, total, user_data);
   data = g_malloc (MAX_CHUNK_SIZE);
   while (!feof (mdatrf->file) && remaining > 0) {
-    gint read, write, readsize;
+    gsize read, write, readsize;
 
     readsize = MIN (MAX_CHUNK_SIZE, remaining);
 
@@ -1180,13 +1212,23 @@ moov_recov_write_file (MoovRecovFile * moovrf, MdatRecovFile * mdatrf,
           "Failed to copy data to output file: %s", g_strerror (errno));
       goto fail;
     }
+
+    if (total - remaining >= next_progress) {
+      if (progress)
+        progress (total - remaining, total, user_data);
+      next_progress += PROGRESS_INTERVAL;
+    }
   }
   g_free (data);
+  data = NULL;
+
+  if (progress)
+    progress (total - remaining, total, user_data);
 
   if (remaining) {
     g_set_error (warn, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_FILE,
         "Samples in recovery file were not present on headers."
-        " Bytes lost: %u", remaining);
+        " Bytes lost: %" G_GUINT64_FORMAT, remaining);
   } else if (!feof (mdatrf->file)) {
     g_set_error (warn, ATOMS_RECOV_QUARK, ATOMS_RECOV_ERR_FILE,
         "Samples in headers were not found in data file.");
@@ -104,7 +104,7 @@ typedef struct
   guint32 stsd_size;
 
   guint32 extra_atoms_size;
-  guint32 extra_atoms_offset;
+  guint64 extra_atoms_offset;
 
   /* for storing the samples info */
   AtomSTBL stbl;
@@ -118,7 +118,7 @@ typedef struct
   /* results from parsing the input file */
   guint64   data_size;
   guint32   mdat_header_size;
-  guint     mdat_start;
+  guint64   mdat_start;
 
   guint64   mdat_size;
 } MdatRecovFile;
@@ -128,7 +128,7 @@ typedef struct
   FILE * file;
   guint32 timescale;
 
-  guint32 mvhd_pos;
+  guint64 mvhd_pos;
   guint32 mvhd_size;
   guint32 prefix_size; /* prefix + ftyp total size */
 
@@ -147,6 +147,11 @@ gboolean atoms_recov_write_trak_samples   (FILE * f, AtomTRAK * trak,
                                            gboolean sync, gboolean do_pts,
                                            gint64 pts_offset);
 
+/* called with the number of media bytes copied so far while writing the
+ * recovered file */
+typedef void (*MoovRecovProgressFunc) (guint64 copied, guint64 total,
+                                       gpointer user_data);
+
 MdatRecovFile * mdat_recov_file_create   (FILE * file, gboolean datafile,
                                           GError ** err);
 void            mdat_recov_file_free     (MdatRecovFile * mrf);
@@ -157,6 +162,8 @@ gboolean        moov_recov_parse_buffers (MoovRecovFile * moovrf,
                                           GError ** err);
 gboolean        moov_recov_write_file    (MoovRecovFile * moovrf,
                                           MdatRecovFile * mdatrf, FILE * outf,
+                                          MoovRecovProgressFunc progress,
+                                          gpointer user_data,
                                           GError ** err, GError ** warn);
 
 #endif /* __ATOMS_RECOVERY_H__ */
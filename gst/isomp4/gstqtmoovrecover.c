@@ -49,6 +49,12 @@
  * This element recovers quicktime files created with qtmux using the moov
  * recovery feature.
  *
+ * While copying the media data to the fixed file, the element posts element
+ * messages named `qtmoovrecover-progress` on the bus. They contain the
+ * number of bytes copied so far in the guint64 field `copied`, the total
+ * number of bytes to copy in the guint64 field `total` and the progress in
+ * percent in the gint field `percent`.
+ *
  * ## Example pipelines
  *
  * |[
@@ -160,6 +166,26 @@ gst_qt_moov_recover_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_qt_moov_recover_progress (guint64 copied, guint64 total,
+    gpointer user_data)
+{
+  GstQTMoovRecover *qtmr = GST_QT_MOOV_RECOVER_CAST (user_data);
+  GstStructure *s;
+  gint percent;
+
+  percent = total > 0 ? gst_util_uint64_scale (copied, 100, total) : 100;
+
+  GST_DEBUG_OBJECT (qtmr, "Copied %" G_GUINT64_FORMAT " of %"
+      G_GUINT64_FORMAT " bytes (%d%%)", copied, total, percent);
+
+  s = gst_structure_new ("qtmoovrecover-progress",
+      "copied", G_TYPE_UINT64, copied, "total", G_TYPE_UINT64, total,
+      "percent", G_TYPE_INT, percent, NULL);
+  gst_element_post_message (GST_ELEMENT_CAST (qtmr),
+      gst_message_new_element (GST_OBJECT_CAST (qtmr), s));
+}
+
 static void
 gst_qt_moov_recover_run (void *data)
 {
@@ -171,6 +197,7 @@ gst_qt_moov_recover_run (void *data)
   GstQTMoovRecover *qtmr = GST_QT_MOOV_RECOVER_CAST (data);
   GError *err = NULL;
   GError *warn = NULL;
+  gint64 start_time;
 
   GST_LOG_OBJECT (qtmr, "Starting task");
 
@@ -245,9 +272,13 @@ gst_qt_moov_recover_run (void *data)
   }
 
   GST_DEBUG_OBJECT (qtmr, "Writing fixed file to output");
-  if (!moov_recov_write_file (moov_recov, mdat_recov, output, &err, &warn)) {
+  start_time = g_get_monotonic_time ();
+  if (!moov_recov_write_file (moov_recov, mdat_recov, output,
+          gst_qt_moov_recover_progress, qtmr, &err, &warn)) {
     goto end;
   }
+  GST_INFO_OBJECT (qtmr, "Wrote fixed file in %" GST_TIME_FORMAT,
+      GST_TIME_ARGS ((g_get_monotonic_time () - start_time) * GST_USECOND));
 
   if (warn) {
     GST_ELEMENT_WARNING (qtmr, RESOURCE, FAILED, ("%s", warn->message), (NULL));
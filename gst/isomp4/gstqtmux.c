@@ -331,11 +331,15 @@ enum
   PROP_START_GAP_THRESHOLD,
   PROP_FORCE_CREATE_TIMECODE_TRAK,
   PROP_FRAGMENT_MODE,
+  PROP_INTERLEAVE_MIN_BYTES,
 };
 
 /* some spare for header size as well */
 #define MDAT_LARGE_FILE_LIMIT           ((guint64) 1024 * 1024 * 1024 * 2)
 
+/* block size used to write and read back the faststart temporary file */
+#define FAST_START_BLOCK_SIZE           (4 * 1024 * 1024)
+
 #define DEFAULT_MOVIE_TIMESCALE         0
 #define DEFAULT_TRAK_TIMESCALE          0
 #define DEFAULT_DO_CTTS                 TRUE
@@ -358,6 +362,10 @@ enum
 #define DEFAULT_START_GAP_THRESHOLD 0
 #define DEFAULT_FORCE_CREATE_TIMECODE_TRAK FALSE
 #define DEFAULT_FRAGMENT_MODE GST_QT_MUX_FRAGMENT_DASH_OR_MSS
+#define DEFAULT_INTERLEAVE_MIN_BYTES 0
+
+/* how far past interleave-time a chunk below interleave-min-bytes may grow */
+#define INTERLEAVE_MIN_BYTES_MAX_TIME_FACTOR 4
 
 static void gst_qt_mux_finalize (GObject * object);
 
@@ -620,6 +628,27 @@ gst_qt_mux_class_init (GstQTMuxClass * klass)
           GST_TYPE_QT_MUX_FRAGMENT_MODE, DEFAULT_FRAGMENT_MODE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBaseQTMux:interleave-min-bytes:
+   *
+   * Chunks of low bitrate streams (audio, metadata) usually reach
+   * 'interleave-time' long before they contain a useful amount of data,
+   * which results in many tiny chunks and large sample tables.
+   *
+   * A chunk that is smaller than this many bytes is not closed when it
+   * reaches 'interleave-time' but may grow up to four times that duration.
+   * As such chunks are small, this barely increases the amount of data a
+   * player has to read ahead. 'interleave-bytes' still applies.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_INTERLEAVE_MIN_BYTES,
+      g_param_spec_uint64 ("interleave-min-bytes", "Interleave minimum (bytes)",
+          "Chunks smaller than this may exceed interleave-time up to four "
+          "times (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_INTERLEAVE_MIN_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_qt_mux_request_new_pad);
   gstelement_class->release_pad = GST_DEBUG_FUNCPTR (gst_qt_mux_release_pad);
@@ -847,6 +876,7 @@ gst_qt_mux_init (GstQTMux * qtmux, GstQTMuxClass * qtmux_klass)
       DEFAULT_RESERVED_BYTES_PER_SEC_PER_TRAK;
   qtmux->interleave_bytes = DEFAULT_INTERLEAVE_BYTES;
   qtmux->interleave_time = DEFAULT_INTERLEAVE_TIME;
+  qtmux->interleave_min_bytes = DEFAULT_INTERLEAVE_MIN_BYTES;
   qtmux->force_chunks = DEFAULT_FORCE_CHUNKS;
   qtmux->max_raw_audio_drift = DEFAULT_MAX_RAW_AUDIO_DRIFT;
   qtmux->start_gap_threshold = DEFAULT_START_GAP_THRESHOLD;
@@ -1947,6 +1977,8 @@ gst_qt_mux_send_buffered_data (GstQTMux * qtmux, guint64 * offset)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *buf = NULL;
+  GstBufferPool *pool;
+  GstStructure *config;
 
   if (fflush (qtmux->fast_start_file))
     goto flush_failed;
@@ -1955,24 +1987,38 @@ gst_qt_mux_send_buffered_data (GstQTMux * qtmux, guint64 * offset)
     goto seek_failed;
 
   /* hm, this could all take a really really long time,
-   * but there may not be another way to get moov atom first
-   * (somehow optimize copy?) */
+   * but there may not be another way to get moov atom first.
+   * Read back in large blocks so that even multi-GB files only take a few
+   * thousand pushes, and recycle the blocks through a pool since downstream
+   * normally releases them right away */
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, FAST_START_BLOCK_SIZE, 0,
+      0);
+  if (!gst_buffer_pool_set_config (pool, config)
+      || !gst_buffer_pool_set_active (pool, TRUE)) {
+    gst_object_unref (pool);
+    goto pool_failed;
+  }
+
   GST_DEBUG_OBJECT (qtmux, "Sending buffered data");
   while (ret == GST_FLOW_OK) {
-    const int bufsize = 4096;
     GstMapInfo map;
     gsize size;
 
-    buf = gst_buffer_new_and_alloc (bufsize);
+    ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+    if (ret != GST_FLOW_OK)
+      break;
     gst_buffer_map (buf, &map, GST_MAP_WRITE);
-    size = fread (map.data, sizeof (guint8), bufsize, qtmux->fast_start_file);
+    size = fread (map.data, sizeof (guint8), FAST_START_BLOCK_SIZE,
+        qtmux->fast_start_file);
     if (size == 0) {
       gst_buffer_unmap (buf, &map);
       break;
     }
     GST_LOG_OBJECT (qtmux, "Pushing buffered buffer of size %d", (gint) size);
     gst_buffer_unmap (buf, &map);
-    if (size != bufsize)
+    if (size != FAST_START_BLOCK_SIZE)
       gst_buffer_set_size (buf, size);
     ret = gst_qt_mux_send_buffer (qtmux, buf, offset, FALSE);
     buf = NULL;
@@ -1980,6 +2026,9 @@ gst_qt_mux_send_buffered_data (GstQTMux * qtmux, guint64 * offset)
   if (buf)
     gst_buffer_unref (buf);
 
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+
   if (ftruncate (fileno (qtmux->fast_start_file), 0))
     goto seek_failed;
   if (!gst_qt_mux_seek_to_beginning (qtmux->fast_start_file))
@@ -1995,6 +2044,13 @@ flush_failed:
     ret = GST_FLOW_ERROR;
     goto fail;
   }
+pool_failed:
+  {
+    GST_ELEMENT_ERROR (qtmux, RESOURCE, FAILED,
+        ("Failed to allocate buffers for the temporary file"), (NULL));
+    ret = GST_FLOW_ERROR;
+    goto fail;
+  }
 seek_failed:
   {
     GST_ELEMENT_ERROR (qtmux, RESOURCE, SEEK,
@@ -2788,6 +2844,34 @@ prefill_update_sample_size (GstQTMux * qtmux, GstQTMuxPad * qpad)
   }
 }
 
+/* Whether the current chunk is still within the interleave limits and more
+ * samples of the current pad can be added to it */
+static gboolean
+gst_qt_mux_current_chunk_within_limits (GstQTMux * qtmux)
+{
+  GstClockTime max_time = qtmux->interleave_time;
+
+  if (qtmux->mux_mode == GST_QT_MUX_MODE_FRAGMENTED)
+    return FALSE;
+
+  if (qtmux->interleave_bytes == 0 && qtmux->interleave_time == 0)
+    return FALSE;
+
+  if (qtmux->interleave_bytes != 0
+      && qtmux->current_chunk_size > qtmux->interleave_bytes)
+    return FALSE;
+
+  /* let chunks of low bitrate streams grow past interleave-time */
+  if (max_time != 0 && qtmux->interleave_min_bytes != 0
+      && qtmux->current_chunk_size < qtmux->interleave_min_bytes)
+    max_time *= INTERLEAVE_MIN_BYTES_MAX_TIME_FACTOR;
+
+  if (max_time != 0 && qtmux->current_chunk_duration > max_time)
+    return FALSE;
+
+  return TRUE;
+}
+
 /* Only called at startup when doing the "fake" iteration of all tracks in order
  * to prefill the sample tables in the header.  */
 static GstQTMuxPad *
@@ -2799,13 +2883,7 @@ find_best_pad_prefill_start (GstQTMux * qtmux)
    * those interleave limits, pick that one, otherwise let's try to figure out
    * the next best one. */
 
-  if (qtmux->current_pad &&
-      (qtmux->interleave_bytes != 0 || qtmux->interleave_time != 0) &&
-      (qtmux->interleave_bytes == 0
-          || qtmux->current_chunk_size <= qtmux->interleave_bytes)
-      && (qtmux->interleave_time == 0
-          || qtmux->current_chunk_duration <= qtmux->interleave_time)
-      && qtmux->mux_mode != GST_QT_MUX_MODE_FRAGMENTED) {
+  if (qtmux->current_pad && gst_qt_mux_current_chunk_within_limits (qtmux)) {
 
     if (qtmux->current_pad->total_duration < qtmux->reserved_max_duration) {
       best_pad = qtmux->current_pad;
@@ -3399,6 +3477,9 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
       qtmux->fast_start_file = g_fopen (qtmux->fast_start_file_path, "wb+");
       if (!qtmux->fast_start_file)
         goto open_failed;
+      /* samples are written one by one, let stdio gather them into large
+       * writes */
+      setvbuf (qtmux->fast_start_file, NULL, _IOFBF, FAST_START_BLOCK_SIZE);
       GST_OBJECT_UNLOCK (qtmux);
       /* send a dummy buffer for preroll */
       ret = gst_qt_mux_send_buffer (qtmux, gst_buffer_new (), NULL, FALSE);
@@ -5562,12 +5643,7 @@ find_best_pad (GstQTMux * qtmux)
     return best_pad;
   }
 
-  if (qtmux->current_pad && (qtmux->interleave_bytes != 0
-          || qtmux->interleave_time != 0) && (qtmux->interleave_bytes == 0
-          || qtmux->current_chunk_size <= qtmux->interleave_bytes)
-      && (qtmux->interleave_time == 0
-          || qtmux->current_chunk_duration <= qtmux->interleave_time)
-      && qtmux->mux_mode != GST_QT_MUX_MODE_FRAGMENTED) {
+  if (qtmux->current_pad && gst_qt_mux_current_chunk_within_limits (qtmux)) {
     GstBuffer *tmp_buf =
         gst_aggregator_pad_peek_buffer (GST_AGGREGATOR_PAD
         (qtmux->current_pad));
@@ -7140,6 +7216,9 @@ gst_qt_mux_get_property (GObject * object,
     case PROP_INTERLEAVE_TIME:
       g_value_set_uint64 (value, qtmux->interleave_time);
       break;
+    case PROP_INTERLEAVE_MIN_BYTES:
+      g_value_set_uint64 (value, qtmux->interleave_min_bytes);
+      break;
     case PROP_FORCE_CHUNKS:
       g_value_set_boolean (value, qtmux->force_chunks);
       break;
@@ -7239,6 +7318,9 @@ gst_qt_mux_set_property (GObject * object,
       qtmux->interleave_time = g_value_get_uint64 (value);
       qtmux->interleave_time_set = TRUE;
       break;
+    case PROP_INTERLEAVE_MIN_BYTES:
+      qtmux->interleave_min_bytes = g_value_get_uint64 (value);
+      break;
     case PROP_FORCE_CHUNKS:
       qtmux->force_chunks = g_value_get_boolean (value);
       break;
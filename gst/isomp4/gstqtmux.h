@@ -323,6 +323,7 @@ struct _GstQTMux
   guint64 interleave_bytes;
   GstClockTime interleave_time;
   gboolean interleave_bytes_set, interleave_time_set;
+  guint64 interleave_min_bytes;
   gboolean force_chunks;
 
   GstClockTime max_raw_audio_drift;
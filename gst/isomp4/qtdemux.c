@@ -87,6 +87,10 @@
 /* if the sample index is larger than this, something is likely wrong */
 #define QTDEMUX_MAX_SAMPLE_INDEX_SIZE (200*1024*1024)
 
+/* number of already pushed samples of a fragmented stream we keep around in
+ * pull mode when seeking can be done through the mfra random access table */
+#define QTDEMUX_FRAGMENTED_SAMPLE_WINDOW 4096
+
 /* For converting qt creation times to unix epoch times */
 #define QTDEMUX_SECONDS_PER_DAY (60 * 60 * 24)
 #define QTDEMUX_LEAP_YEARS_FROM_1904_TO_1970 17
@@ -112,6 +116,8 @@ GST_DEBUG_CATEGORY (qtdemux_debug);
 #define GST_CAT_DEFAULT qtdemux_debug
 
 typedef struct _QtDemuxCencSampleSetInfo QtDemuxCencSampleSetInfo;
+typedef struct _QtDemuxCencAuxInfoBlock QtDemuxCencAuxInfoBlock;
+typedef struct _QtDemuxCencSampleAuxInfo QtDemuxCencSampleAuxInfo;
 typedef struct _QtDemuxAavdEncryptionInfo QtDemuxAavdEncryptionInfo;
 
 /* Macros for converting to/from timescale */
@@ -226,14 +232,38 @@ struct _QtDemuxRandomAccessEntry
 };
 
 
+/* Raw sample auxiliary information of one fragment together with the
+ * default properties that were in effect when it was parsed. Shared by all
+ * samples of the fragment. */
+struct _QtDemuxCencAuxInfoBlock
+{
+  gint ref_count;
+  GstStructure *default_properties;
+  GstBuffer *data;
+};
+
+/* Location of the cryptographic info of one sample inside its block. The
+ * GstStructure for the protection meta is only built when the sample is
+ * pushed. @block is NULL once the entry has been consumed. @has_iv is also
+ * set for PIFF samples with an empty IV. */
+struct _QtDemuxCencSampleAuxInfo
+{
+  QtDemuxCencAuxInfoBlock *block;
+  guint32 iv_offset;
+  guint32 subsamples_offset;
+  guint16 n_subsamples;
+  guint8 iv_size;
+  gboolean has_iv;
+};
+
 /* Contains properties and cryptographic info for a set of samples from a
  * track protected using Common Encryption (cenc) */
 struct _QtDemuxCencSampleSetInfo
 {
   GstStructure *default_properties;
 
-  /* @crypto_info holds one GstStructure per sample */
-  GPtrArray *crypto_info;
+  /* @crypto_info holds one QtDemuxCencSampleAuxInfo per sample */
+  GArray *crypto_info;
 };
 
 struct _QtDemuxAavdEncryptionInfo
@@ -2513,6 +2543,45 @@ gst_qtdemux_stream_flush_samples_data (QtDemuxStream * stream)
   stream->duration_last_moof = 0;
 }
 
+/* In pull mode the sample table of a fragmented stream grows with every
+ * parsed moof. When seeks are resolved through the mfra random access table,
+ * which starts again from an empty table, samples well behind the current
+ * position are never needed again and can be dropped so that long or
+ * continuously growing files use a bounded amount of memory.
+ * Must be called with the object lock and outside of sample parsing. */
+static void
+gst_qtdemux_stream_trim_samples (GstQTDemux * qtdemux, QtDemuxStream * stream)
+{
+  guint32 n_drop;
+
+  if (stream->ra_entries == NULL || stream->stsz.data != NULL)
+    return;
+
+  if (stream->sample_index == -1
+      || stream->sample_index < 2 * QTDEMUX_FRAGMENTED_SAMPLE_WINDOW
+      || stream->stbl_index < stream->sample_index)
+    return;
+
+  n_drop = stream->sample_index - QTDEMUX_FRAGMENTED_SAMPLE_WINDOW;
+
+  GST_DEBUG_OBJECT (qtdemux, "track-id %u: dropping %u of %u samples",
+      stream->track_id, n_drop, stream->n_samples);
+
+  stream->n_samples -= n_drop;
+  memmove (stream->samples, stream->samples + n_drop,
+      stream->n_samples * sizeof (QtDemuxSample));
+  stream->samples = g_renew (QtDemuxSample, stream->samples,
+      stream->n_samples);
+
+  stream->sample_index -= n_drop;
+  stream->stbl_index -= n_drop;
+  stream->from_sample = stream->from_sample > n_drop ?
+      stream->from_sample - n_drop : 0;
+  if (stream->to_sample != G_MAXUINT32)
+    stream->to_sample = stream->to_sample > n_drop ?
+        stream->to_sample - n_drop : 0;
+}
+
 static void
 gst_qtdemux_stream_clear (QtDemuxStream * stream)
 {
@@ -2549,7 +2618,7 @@ gst_qtdemux_stream_clear (QtDemuxStream * stream)
       if (info->default_properties)
         gst_structure_free (info->default_properties);
       if (info->crypto_info)
-        g_ptr_array_free (info->crypto_info, TRUE);
+        g_array_free (info->crypto_info, TRUE);
     }
     if (stream->protection_scheme_type == FOURCC_aavd) {
       QtDemuxAavdEncryptionInfo *info =
@@ -2761,6 +2830,100 @@ qtdemux_update_default_piff_encryption_settings (GstQTDemux * qtdemux,
 }
 
 
+static QtDemuxCencAuxInfoBlock *
+qtdemux_cenc_aux_info_block_new (const GstStructure * default_properties,
+    const guint8 * data, gsize size)
+{
+  QtDemuxCencAuxInfoBlock *block = g_new (QtDemuxCencAuxInfoBlock, 1);
+
+  block->ref_count = 1;
+  block->default_properties = gst_structure_copy (default_properties);
+  block->data = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_fill (block->data, 0, data, size);
+
+  return block;
+}
+
+static QtDemuxCencAuxInfoBlock *
+qtdemux_cenc_aux_info_block_ref (QtDemuxCencAuxInfoBlock * block)
+{
+  block->ref_count++;
+  return block;
+}
+
+static void
+qtdemux_cenc_aux_info_block_unref (QtDemuxCencAuxInfoBlock * block)
+{
+  if (--block->ref_count > 0)
+    return;
+
+  gst_structure_free (block->default_properties);
+  gst_buffer_unref (block->data);
+  g_free (block);
+}
+
+static void
+qtdemux_cenc_sample_aux_info_clear (QtDemuxCencSampleAuxInfo * aux)
+{
+  if (aux->block) {
+    qtdemux_cenc_aux_info_block_unref (aux->block);
+    aux->block = NULL;
+  }
+}
+
+static GArray *
+qtdemux_cenc_sample_aux_info_array_new (guint reserved_size)
+{
+  GArray *array;
+
+  array = g_array_sized_new (FALSE, FALSE, sizeof (QtDemuxCencSampleAuxInfo),
+      reserved_size);
+  g_array_set_clear_func (array,
+      (GDestroyNotify) qtdemux_cenc_sample_aux_info_clear);
+
+  return array;
+}
+
+/* Builds the protection meta structure for one sample. The IV and subsample
+ * buffers share the memory of the fragment's auxiliary info block. */
+static GstStructure *
+qtdemux_cenc_sample_aux_info_to_structure (QtDemuxStream * stream,
+    const QtDemuxCencSampleAuxInfo * aux)
+{
+  GstStructure *properties;
+  GstBuffer *buf;
+
+  properties = gst_structure_copy (aux->block->default_properties);
+
+  if (aux->has_iv) {
+    if (aux->iv_size > 0)
+      buf = gst_buffer_copy_region (aux->block->data, GST_BUFFER_COPY_MEMORY,
+          aux->iv_offset, aux->iv_size);
+    else
+      buf = gst_buffer_new ();
+    gst_structure_set (properties, "iv", GST_TYPE_BUFFER, buf, NULL);
+    gst_buffer_unref (buf);
+  } else if (stream->protection_scheme_type == FOURCC_cbcs) {
+    /* constant IV, presence of the fields was checked when parsing */
+    gst_structure_set_value (properties, "iv_size",
+        gst_structure_get_value (properties, "constant_iv_size"));
+    gst_structure_remove_field (properties, "constant_iv_size");
+  }
+
+  if (aux->n_subsamples > 0) {
+    buf = gst_buffer_copy_region (aux->block->data, GST_BUFFER_COPY_MEMORY,
+        aux->subsamples_offset, aux->n_subsamples * 6);
+    gst_structure_set (properties,
+        "subsample_count", G_TYPE_UINT, aux->n_subsamples,
+        "subsamples", GST_TYPE_BUFFER, buf, NULL);
+    gst_buffer_unref (buf);
+  } else {
+    gst_structure_set (properties, "subsample_count", G_TYPE_UINT, 0, NULL);
+  }
+
+  return properties;
+}
+
 static void
 qtdemux_parse_piff (GstQTDemux * qtdemux, const guint8 * buffer, gint length,
     guint offset)
@@ -2773,9 +2936,11 @@ qtdemux_parse_piff (GstQTDemux * qtdemux, const guint8 * buffer, gint length,
   QtDemuxStream *stream;
   GstStructure *structure;
   QtDemuxCencSampleSetInfo *ss_info = NULL;
+  QtDemuxCencAuxInfoBlock *block;
   const gchar *system_id;
   gboolean uses_sub_sample_encryption = FALSE;
   guint32 sample_count;
+  guint block_start;
 
   if (QTDEMUX_N_STREAMS (qtdemux) == 0)
     return;
@@ -2810,7 +2975,7 @@ qtdemux_parse_piff (GstQTDemux * qtdemux, const guint8 * buffer, gint length,
 
   if (ss_info->crypto_info) {
     GST_LOG_OBJECT (qtdemux, "unreffing existing crypto_info");
-    g_ptr_array_free (ss_info->crypto_info, TRUE);
+    g_array_free (ss_info->crypto_info, TRUE);
     ss_info->crypto_info = NULL;
   }
 
@@ -2846,70 +3011,60 @@ qtdemux_parse_piff (GstQTDemux * qtdemux, const guint8 * buffer, gint length,
     return;
   }
 
-  ss_info->crypto_info =
-      g_ptr_array_new_full (sample_count,
-      (GDestroyNotify) qtdemux_gst_structure_free);
+  if (iv_size > G_MAXUINT8) {
+    GST_ERROR_OBJECT (qtdemux, "Invalid IV size %u", iv_size);
+    return;
+  }
 
-  for (i = 0; i < sample_count; ++i) {
-    GstStructure *properties;
-    guint8 *data;
-    GstBuffer *buf;
+  ss_info->crypto_info = qtdemux_cenc_sample_aux_info_array_new (sample_count);
 
-    properties = qtdemux_get_cenc_sample_properties (qtdemux, stream, i);
-    if (properties == NULL) {
-      GST_ERROR_OBJECT (qtdemux, "failed to get properties for sample %u", i);
-      qtdemux->cenc_aux_sample_count = i;
-      return;
-    }
+  /* keep one copy of the per-sample data, samples refer into it */
+  block_start = gst_byte_reader_get_pos (&br);
+  block = qtdemux_cenc_aux_info_block_new (ss_info->default_properties,
+      gst_byte_reader_peek_data_unchecked (&br),
+      gst_byte_reader_get_remaining (&br));
 
-    if (!gst_byte_reader_dup_data (&br, iv_size, &data)) {
+  for (i = 0; i < sample_count; ++i) {
+    QtDemuxCencSampleAuxInfo aux = { NULL, };
+
+    aux.iv_offset = gst_byte_reader_get_pos (&br) - block_start;
+    aux.iv_size = iv_size;
+    aux.has_iv = TRUE;
+    if (!gst_byte_reader_skip (&br, iv_size)) {
       GST_ERROR_OBJECT (qtdemux, "IV data not present for sample %u", i);
-      gst_structure_free (properties);
       qtdemux->cenc_aux_sample_count = i;
-      return;
+      goto done;
     }
-    buf = gst_buffer_new_wrapped (data, iv_size);
-    gst_structure_set (properties, "iv", GST_TYPE_BUFFER, buf, NULL);
-    gst_buffer_unref (buf);
 
     if (uses_sub_sample_encryption) {
       guint16 n_subsamples;
-      const GValue *kid_buf_value;
 
       if (!gst_byte_reader_get_uint16_be (&br, &n_subsamples)
           || n_subsamples == 0) {
         GST_ERROR_OBJECT (qtdemux,
             "failed to get subsample count for sample %u", i);
-        gst_structure_free (properties);
         qtdemux->cenc_aux_sample_count = i;
-        return;
+        goto done;
       }
       GST_LOG_OBJECT (qtdemux, "subsample count: %u", n_subsamples);
-      if (!gst_byte_reader_dup_data (&br, n_subsamples * 6, &data)) {
+      aux.subsamples_offset = gst_byte_reader_get_pos (&br) - block_start;
+      aux.n_subsamples = n_subsamples;
+      if (!gst_byte_reader_skip (&br, n_subsamples * 6)) {
         GST_ERROR_OBJECT (qtdemux, "failed to get subsample data for sample %u",
             i);
-        gst_structure_free (properties);
         qtdemux->cenc_aux_sample_count = i;
-        return;
+        goto done;
       }
-      buf = gst_buffer_new_wrapped (data, n_subsamples * 6);
-
-      kid_buf_value =
-          gst_structure_get_value (ss_info->default_properties, "kid");
-
-      gst_structure_set (properties,
-          "subsample_count", G_TYPE_UINT, n_subsamples,
-          "subsamples", GST_TYPE_BUFFER, buf, NULL);
-      gst_structure_set_value (properties, "kid", kid_buf_value);
-      gst_buffer_unref (buf);
-    } else {
-      gst_structure_set (properties, "subsample_count", G_TYPE_UINT, 0, NULL);
     }
 
-    g_ptr_array_add (ss_info->crypto_info, properties);
+    aux.block = qtdemux_cenc_aux_info_block_ref (block);
+    g_array_append_val (ss_info->crypto_info, aux);
   }
 
   qtdemux->cenc_aux_sample_count = sample_count;
+
+done:
+  qtdemux_cenc_aux_info_block_unref (block);
 }
 
 static void
@@ -3778,10 +3933,14 @@ qtdemux_parse_cenc_aux_info (GstQTDemux * qtdemux, QtDemuxStream * stream,
     GstByteReader * br, guint8 * info_sizes, guint32 sample_count)
 {
   QtDemuxCencSampleSetInfo *ss_info = NULL;
+  QtDemuxCencAuxInfoBlock *block;
+  GArray *old_crypto_info = NULL;
+  guint old_entries = 0;
+  guint iv_size, block_start;
+  gsize block_size = 0;
+  gboolean ret = FALSE;
   guint8 size;
   gint i;
-  GPtrArray *old_crypto_info = NULL;
-  guint old_entries = 0;
 
   g_return_val_if_fail (qtdemux != NULL, FALSE);
   g_return_val_if_fail (stream != NULL, FALSE);
@@ -3791,19 +3950,27 @@ qtdemux_parse_cenc_aux_info (GstQTDemux * qtdemux, QtDemuxStream * stream,
 
   ss_info = (QtDemuxCencSampleSetInfo *) stream->protection_scheme_info;
 
+  /* all samples of a fragment share the default properties, so the IV size
+   * is the same for all of them */
+  if (!gst_structure_get_uint (ss_info->default_properties, "iv_size",
+          &iv_size) || iv_size > G_MAXUINT8) {
+    GST_ERROR_OBJECT (qtdemux, "failed to get iv_size");
+    return FALSE;
+  }
+
   if (ss_info->crypto_info) {
     old_crypto_info = ss_info->crypto_info;
-    /* Count number of non-null entries remaining at the tail end */
+    /* Count number of non-consumed entries remaining at the tail end */
     for (i = old_crypto_info->len - 1; i >= 0; i--) {
-      if (g_ptr_array_index (old_crypto_info, i) == NULL)
+      if (g_array_index (old_crypto_info, QtDemuxCencSampleAuxInfo,
+              i).block == NULL)
         break;
       old_entries++;
     }
   }
 
   ss_info->crypto_info =
-      g_ptr_array_new_full (sample_count + old_entries,
-      (GDestroyNotify) qtdemux_gst_structure_free);
+      qtdemux_cenc_sample_aux_info_array_new (sample_count + old_entries);
 
   /* We preserve old entries because we parse the next moof in advance
    * of consuming all samples from the previous moof, and otherwise
@@ -3813,89 +3980,78 @@ qtdemux_parse_cenc_aux_info (GstQTDemux * qtdemux, QtDemuxStream * stream,
     GST_DEBUG_OBJECT (qtdemux, "Preserving %d old crypto info entries",
         old_entries);
     for (i = old_crypto_info->len - old_entries; i < old_crypto_info->len; i++) {
-      g_ptr_array_add (ss_info->crypto_info, g_ptr_array_index (old_crypto_info,
-              i));
-      g_ptr_array_index (old_crypto_info, i) = NULL;
+      QtDemuxCencSampleAuxInfo *aux =
+          &g_array_index (old_crypto_info, QtDemuxCencSampleAuxInfo, i);
+
+      g_array_append_val (ss_info->crypto_info, *aux);
+      aux->block = NULL;
     }
   }
 
   if (old_crypto_info) {
     /* Everything now belongs to the new array */
-    g_ptr_array_free (old_crypto_info, TRUE);
+    g_array_free (old_crypto_info, TRUE);
   }
 
+  /* Instead of duplicating the IV and subsample data of every sample, keep a
+   * single copy of the auxiliary info of the whole fragment and only remember
+   * where each sample's data is. */
+  for (i = 0; i < sample_count; ++i)
+    block_size += info_sizes[i];
+  block_size = MIN (block_size, gst_byte_reader_get_remaining (br));
+  block_start = gst_byte_reader_get_pos (br);
+  block = qtdemux_cenc_aux_info_block_new (ss_info->default_properties,
+      gst_byte_reader_peek_data_unchecked (br), block_size);
+
   for (i = 0; i < sample_count; ++i) {
-    GstStructure *properties;
+    QtDemuxCencSampleAuxInfo aux = { NULL, };
     guint16 n_subsamples = 0;
-    guint8 *data;
-    guint iv_size;
-    GstBuffer *buf;
     gboolean could_read_iv;
 
-    properties = qtdemux_get_cenc_sample_properties (qtdemux, stream, i);
-    if (properties == NULL) {
-      GST_ERROR_OBJECT (qtdemux, "failed to get properties for sample %u", i);
-      return FALSE;
-    }
-    if (!gst_structure_get_uint (properties, "iv_size", &iv_size)) {
-      GST_ERROR_OBJECT (qtdemux, "failed to get iv_size for sample %u", i);
-      gst_structure_free (properties);
-      return FALSE;
-    }
-    could_read_iv =
-        iv_size > 0 ? gst_byte_reader_dup_data (br, iv_size, &data) : FALSE;
+    aux.iv_offset = gst_byte_reader_get_pos (br) - block_start;
+    could_read_iv = iv_size > 0 && aux.iv_offset + iv_size <= block_size
+        && gst_byte_reader_skip (br, iv_size);
     if (could_read_iv) {
-      buf = gst_buffer_new_wrapped (data, iv_size);
-      gst_structure_set (properties, "iv", GST_TYPE_BUFFER, buf, NULL);
-      gst_buffer_unref (buf);
+      aux.iv_size = iv_size;
+      aux.has_iv = TRUE;
     } else if (stream->protection_scheme_type == FOURCC_cbcs) {
-      const GValue *constant_iv_size_value =
-          gst_structure_get_value (properties, "constant_iv_size");
-      const GValue *constant_iv_value =
-          gst_structure_get_value (properties, "iv");
-      if (constant_iv_size_value == NULL || constant_iv_value == NULL) {
+      if (!gst_structure_has_field (ss_info->default_properties,
+              "constant_iv_size")
+          || !gst_structure_has_field (ss_info->default_properties, "iv")) {
         GST_ERROR_OBJECT (qtdemux, "failed to get constant_iv");
-        gst_structure_free (properties);
-        return FALSE;
+        goto done;
       }
-      gst_structure_set_value (properties, "iv_size", constant_iv_size_value);
-      gst_structure_remove_field (properties, "constant_iv_size");
     } else if (stream->protection_scheme_type == FOURCC_cenc) {
       GST_ERROR_OBJECT (qtdemux, "failed to get IV for sample %u", i);
-      gst_structure_free (properties);
-      return FALSE;
+      goto done;
     }
     size = info_sizes[i];
     if (size > iv_size) {
       if (!gst_byte_reader_get_uint16_be (br, &n_subsamples)
           || !(n_subsamples > 0)) {
-        gst_structure_free (properties);
         GST_ERROR_OBJECT (qtdemux,
             "failed to get subsample count for sample %u", i);
-        return FALSE;
+        goto done;
       }
       GST_LOG_OBJECT (qtdemux, "subsample count: %u", n_subsamples);
-      if (!gst_byte_reader_dup_data (br, n_subsamples * 6, &data)) {
+      aux.subsamples_offset = gst_byte_reader_get_pos (br) - block_start;
+      aux.n_subsamples = n_subsamples;
+      if (aux.subsamples_offset + n_subsamples * 6 > block_size
+          || !gst_byte_reader_skip (br, n_subsamples * 6)) {
         GST_ERROR_OBJECT (qtdemux, "failed to get subsample data for sample %u",
             i);
-        gst_structure_free (properties);
-        return FALSE;
-      }
-      buf = gst_buffer_new_wrapped (data, n_subsamples * 6);
-      if (!buf) {
-        gst_structure_free (properties);
-        return FALSE;
+        goto done;
       }
-      gst_structure_set (properties,
-          "subsample_count", G_TYPE_UINT, n_subsamples,
-          "subsamples", GST_TYPE_BUFFER, buf, NULL);
-      gst_buffer_unref (buf);
-    } else {
-      gst_structure_set (properties, "subsample_count", G_TYPE_UINT, 0, NULL);
     }
-    g_ptr_array_add (ss_info->crypto_info, properties);
+    aux.block = qtdemux_cenc_aux_info_block_ref (block);
+    g_array_append_val (ss_info->crypto_info, aux);
   }
-  return TRUE;
+  ret = TRUE;
+
+done:
+  qtdemux_cenc_aux_info_block_unref (block);
+
+  return ret;
 }
 
 /* Converts a UUID in raw byte form to a string representation, as defined in
@@ -5819,9 +5975,15 @@ gst_qtdemux_push_buffer (GstQTDemux * qtdemux, QtDemuxStream * stream,
        * so count backward from there */
       index = stream->sample_index - stream->n_samples + info->crypto_info->len;
       if (G_LIKELY (index >= 0 && index < info->crypto_info->len)) {
-        /* steal structure from array */
-        crypto_info = g_ptr_array_index (info->crypto_info, index);
-        g_ptr_array_index (info->crypto_info, index) = NULL;
+        QtDemuxCencSampleAuxInfo *aux = &g_array_index (info->crypto_info,
+            QtDemuxCencSampleAuxInfo, index);
+
+        /* build the structure from the entry and release it */
+        crypto_info = NULL;
+        if (aux->block) {
+          crypto_info = qtdemux_cenc_sample_aux_info_to_structure (stream, aux);
+          qtdemux_cenc_sample_aux_info_clear (aux);
+        }
         GST_LOG_OBJECT (qtdemux, "attaching cenc metadata [%u/%u]", index,
             info->crypto_info->len);
         if (!crypto_info || !gst_buffer_add_protection_meta (buf, crypto_info))
@@ -6191,7 +6353,7 @@ gst_qtdemux_do_fragmented_seek (GstQTDemux * qtdemux)
         QtDemuxCencSampleSetInfo *info =
             (QtDemuxCencSampleSetInfo *) stream->protection_scheme_info;
         if (info->crypto_info) {
-          g_ptr_array_free (info->crypto_info, TRUE);
+          g_array_free (info->crypto_info, TRUE);
           info->crypto_info = NULL;
         }
       }
@@ -6239,6 +6401,14 @@ gst_qtdemux_loop_state_movie (GstQTDemux * qtdemux)
     }
   }
 
+  if (qtdemux->fragmented && qtdemux->segment.rate > 0) {
+    GST_OBJECT_LOCK (qtdemux);
+    for (i = 0; i < QTDEMUX_N_STREAMS (qtdemux); i++)
+      gst_qtdemux_stream_trim_samples (qtdemux, QTDEMUX_NTH_STREAM (qtdemux,
+              i));
+    GST_OBJECT_UNLOCK (qtdemux);
+  }
+
   /* Figure out the next stream sample to output, min_time is expressed in
    * global time and runs over the edit list segments. */
   min_time = G_MAXUINT64;
@@ -5310,6 +5310,9 @@ gst_matroska_demux_parse_contents (GstMatroskaDemux * demux, GstEbmlRead * ebml)
 
 #define MAX_BLOCK_SIZE (15 * 1024 * 1024)
 
+/* clusters up to this size are read in one go in pull mode */
+#define MAX_CLUSTER_PREFETCH_SIZE (16 * 1024 * 1024)
+
 static inline GstFlowReturn
 gst_matroska_demux_check_read_size (GstMatroskaDemux * demux, guint64 bytes)
 {
@@ -5709,6 +5712,18 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
           /* record next cluster for recovery */
           if (read != G_MAXUINT64)
             demux->next_cluster_offset = demux->cluster_offset + read;
+          /* pull the whole cluster at once, its blocks are then parsed from
+           * memory instead of issuing a pull_range for each of them */
+          if (!demux->streaming && read != G_MAXUINT64
+              && needed + read <= MAX_CLUSTER_PREFETCH_SIZE) {
+            GstFlowReturn pret;
+
+            pret = gst_matroska_read_common_prefetch_pull (&demux->common,
+                needed + read);
+            if (pret != GST_FLOW_OK)
+              GST_DEBUG_OBJECT (demux, "cluster prefetch failed: %s",
+                  gst_flow_get_name (pret));
+          }
           /* eat cluster prefix */
           gst_matroska_demux_flush (demux, needed);
           break;
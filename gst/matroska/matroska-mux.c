@@ -76,6 +76,7 @@ enum
   PROP_MAX_CLUSTER_DURATION,
   PROP_OFFSET_TO_ZERO,
   PROP_CREATION_TIME,
+  PROP_MAX_CLUSTER_SIZE,
 };
 
 #define  DEFAULT_DOCTYPE_VERSION         2
@@ -86,6 +87,7 @@ enum
 #define  DEFAULT_MIN_CLUSTER_DURATION    500 * GST_MSECOND
 #define  DEFAULT_MAX_CLUSTER_DURATION    65535 * GST_MSECOND
 #define  DEFAULT_OFFSET_TO_ZERO          FALSE
+#define  DEFAULT_MAX_CLUSTER_SIZE        0
 
 /* WAVEFORMATEX is gst_riff_strf_auds + an extra guint16 extension size */
 #define WAVEFORMATEX_SIZE  (2 + sizeof (gst_riff_strf_auds))
@@ -380,6 +382,25 @@ gst_matroska_mux_class_init (GstMatroskaMuxClass * klass)
           " NULL means that the current time will be used.",
           G_TYPE_DATE_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMatroskaMux:max-cluster-size:
+   *
+   * Caps the size of a cluster in bytes. A new cluster is started before the
+   * next block once the current one is larger than this, even if no keyframe
+   * was seen. Together with #GstMatroskaMux:min-cluster-duration set to 0 and
+   * #GstMatroskaMux:streamable this gives one cluster per GOP for live
+   * streaming, with an upper bound on how much a client has to receive before
+   * it can process a cluster.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_CLUSTER_SIZE,
+      g_param_spec_uint64 ("max-cluster-size", "Maximum cluster size",
+          "A new cluster will be created if its size in bytes exceeds this "
+          "value. 0 means no maximum size.", 0, G_MAXUINT64,
+          DEFAULT_MAX_CLUSTER_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_matroska_mux_change_state);
   gstelement_class->request_new_pad =
@@ -508,6 +529,7 @@ gst_matroska_mux_init (GstMatroskaMux * mux, gpointer g_class)
   mux->time_scale = DEFAULT_TIMECODESCALE;
   mux->min_cluster_duration = DEFAULT_MIN_CLUSTER_DURATION;
   mux->max_cluster_duration = DEFAULT_MAX_CLUSTER_DURATION;
+  mux->max_cluster_size = DEFAULT_MAX_CLUSTER_SIZE;
 
   /* initialize internal variables */
   mux->index = NULL;
@@ -3836,6 +3858,7 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
   gboolean is_audio_only = FALSE;
   gboolean is_min_duration_reached = FALSE;
   gboolean is_max_duration_exceeded = FALSE;
+  gboolean is_max_size_exceeded = FALSE;
   GstMatroskamuxPad *pad;
   gint flags = 0;
   GstClockTime buffer_timestamp;
@@ -3925,11 +3948,14 @@ gst_matroska_mux_write_data (GstMatroskaMux * mux, GstMatroskaPad * collect_pad,
       && buffer_timestamp > mux->cluster_time
       && (buffer_timestamp - mux->cluster_time) >=
       MIN (G_MAXINT16 * mux->time_scale, mux->max_cluster_duration));
+  is_max_size_exceeded = (mux->cluster && mux->max_cluster_size > 0
+      && ebml->pos - mux->cluster_pos >= mux->max_cluster_size);
 
   if (mux->cluster) {
     /* start a new cluster at every keyframe, at every GstForceKeyUnit event,
-     * or when we may be reaching the limit of the relative timestamp */
-    if (is_max_duration_exceeded || (is_video_keyframe
+     * or when we may be reaching the limit of the relative timestamp or the
+     * configured maximum size */
+    if (is_max_duration_exceeded || is_max_size_exceeded || (is_video_keyframe
             && is_min_duration_reached) || mux->force_key_unit_event
         || (is_audio_only && is_min_duration_reached)) {
       if (!mux->ebml_write->streamable)
@@ -4296,6 +4322,9 @@ gst_matroska_mux_set_property (GObject * object,
     case PROP_MAX_CLUSTER_DURATION:
       mux->max_cluster_duration = g_value_get_int64 (value);
       break;
+    case PROP_MAX_CLUSTER_SIZE:
+      mux->max_cluster_size = g_value_get_uint64 (value);
+      break;
     case PROP_OFFSET_TO_ZERO:
       mux->offset_to_zero = g_value_get_boolean (value);
       break;
@@ -4340,6 +4369,9 @@ gst_matroska_mux_get_property (GObject * object,
     case PROP_MAX_CLUSTER_DURATION:
       g_value_set_int64 (value, mux->max_cluster_duration);
       break;
+    case PROP_MAX_CLUSTER_SIZE:
+      g_value_set_uint64 (value, mux->max_cluster_size);
+      break;
     case PROP_OFFSET_TO_ZERO:
       g_value_set_boolean (value, mux->offset_to_zero);
       break;
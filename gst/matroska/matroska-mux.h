@@ -113,6 +113,8 @@ struct _GstMatroskaMux {
   /* minimum and maximum limit of nanoseconds you can have in a cluster */
   guint64        max_cluster_duration;
   guint64        min_cluster_duration;
+  /* maximum size of a cluster in bytes, 0 for no limit */
+  guint64        max_cluster_size;
 
   /* earliest timestamp (time, ns) if offsetting to zero */
   gboolean       offset_to_zero;
@@ -2859,6 +2859,45 @@ gst_matroska_read_common_peek_bytes (GstMatroskaReadCommon * common, guint64
   return GST_FLOW_OK;
 }
 
+/*
+ * Makes sure the cache holds @size bytes from the current offset, using a
+ * single pull_range if it does not already. Subsequent peeks within that
+ * range are then served from memory, as sub-buffers of the cache.
+ */
+GstFlowReturn
+gst_matroska_read_common_prefetch_pull (GstMatroskaReadCommon * common,
+    guint size)
+{
+  GstFlowReturn ret;
+
+  if (common->cached_buffer) {
+    guint64 cache_offset = GST_BUFFER_OFFSET (common->cached_buffer);
+    gsize cache_size = gst_buffer_get_size (common->cached_buffer);
+
+    if (cache_offset <= common->offset &&
+        (common->offset + size) <= (cache_offset + cache_size))
+      return GST_FLOW_OK;
+
+    if (common->cached_data) {
+      gst_buffer_unmap (common->cached_buffer, &common->cached_map);
+      common->cached_data = NULL;
+    }
+    gst_buffer_unref (common->cached_buffer);
+    common->cached_buffer = NULL;
+  }
+
+  GST_LOG_OBJECT (common->sinkpad, "prefetching %u bytes at offset %"
+      G_GUINT64_FORMAT, size, common->offset);
+
+  /* a short buffer is fine, peeking will refill past its end */
+  ret = gst_pad_pull_range (common->sinkpad, common->offset,
+      MAX (size, 64 * 1024), &common->cached_buffer);
+  if (ret != GST_FLOW_OK)
+    common->cached_buffer = NULL;
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_matroska_read_common_peek_pull (GstMatroskaReadCommon * common, guint peek,
     guint8 ** data)
@@ -149,6 +149,8 @@ GstFlowReturn gst_matroska_read_common_parse_skip (GstMatroskaReadCommon *
     common, GstEbmlRead * ebml, const gchar * parent_name, guint id);
 GstFlowReturn gst_matroska_read_common_peek_bytes (GstMatroskaReadCommon *
     common, guint64 offset, guint size, GstBuffer ** p_buf, guint8 ** bytes);
+GstFlowReturn gst_matroska_read_common_prefetch_pull (GstMatroskaReadCommon *
+    common, guint size);
 GstFlowReturn gst_matroska_read_common_peek_id_length_pull (GstMatroskaReadCommon *
     common, GstElement * el, guint32 * _id, guint64 * _length, guint *
     _needed);
@@ -120,6 +120,7 @@ plugin_init (GstPlugin * plugin)
   ret |= GST_ELEMENT_REGISTER (rtpvrawpay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpstreampay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpstreamdepay, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtptemporalfilter, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpisacpay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpisacdepay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpredenc, plugin);
@@ -80,6 +80,15 @@ static GstStaticPadTemplate gst_rtp_L16_depay_sink_template =
     )
     );
 
+#define DEFAULT_AGGREGATE_TIME 0
+#define MAX_AGGREGATE_TIME GST_SECOND
+
+enum
+{
+  PROP_0,
+  PROP_AGGREGATE_TIME
+};
+
 #define gst_rtp_L16_depay_parent_class parent_class
 G_DEFINE_TYPE (GstRtpL16Depay, gst_rtp_L16_depay, GST_TYPE_RTP_BASE_DEPAYLOAD);
 GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpL16depay, "rtpL16depay",
@@ -89,18 +98,54 @@ static gboolean gst_rtp_L16_depay_setcaps (GstRTPBaseDepayload * depayload,
     GstCaps * caps);
 static GstBuffer *gst_rtp_L16_depay_process (GstRTPBaseDepayload * depayload,
     GstRTPBuffer * rtp);
+static gboolean gst_rtp_L16_depay_handle_event (GstRTPBaseDepayload * filter,
+    GstEvent * event);
+static GstStateChangeReturn gst_rtp_L16_depay_change_state (GstElement *
+    element, GstStateChange transition);
+static void gst_rtp_L16_depay_finalize (GObject * object);
+static void gst_rtp_L16_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_L16_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static void
 gst_rtp_L16_depay_class_init (GstRtpL16DepayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstRTPBaseDepayloadClass *gstrtpbasedepayload_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasedepayload_class = (GstRTPBaseDepayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_L16_depay_finalize;
+  gobject_class->set_property = gst_rtp_L16_depay_set_property;
+  gobject_class->get_property = gst_rtp_L16_depay_get_property;
+
+  /**
+   * GstRtpL16Depay:aggregate-time:
+   *
+   * Collect the payloads of consecutive packets into output buffers of at
+   * least this duration. Useful for streams with very short packet times,
+   * such as AES67 with 1ms or 125us packets, where pushing one small buffer
+   * per packet is expensive downstream. Pending data is pushed out early
+   * on discontinuities, timestamp gaps, talk spurts and EOS.
+   * 0 disables aggregation.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_AGGREGATE_TIME,
+      g_param_spec_uint64 ("aggregate-time", "Aggregate Time",
+          "Minimum duration of output buffers in nanoseconds "
+          "(0 = one buffer per packet)", 0, MAX_AGGREGATE_TIME,
+          DEFAULT_AGGREGATE_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gstelement_class->change_state = gst_rtp_L16_depay_change_state;
+
   gstrtpbasedepayload_class->set_caps = gst_rtp_L16_depay_setcaps;
   gstrtpbasedepayload_class->process_rtp_packet = gst_rtp_L16_depay_process;
+  gstrtpbasedepayload_class->handle_event = gst_rtp_L16_depay_handle_event;
 
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_rtp_L16_depay_src_template);
@@ -119,6 +164,51 @@ gst_rtp_L16_depay_class_init (GstRtpL16DepayClass * klass)
 static void
 gst_rtp_L16_depay_init (GstRtpL16Depay * rtpL16depay)
 {
+  gst_rtp_audio_aggregate_init (&rtpL16depay->aggregate,
+      GST_RTP_BASE_DEPAYLOAD (rtpL16depay), &rtpL16depay->info);
+  rtpL16depay->aggregate.aggregate_time = DEFAULT_AGGREGATE_TIME;
+}
+
+static void
+gst_rtp_L16_depay_finalize (GObject * object)
+{
+  GstRtpL16Depay *rtpL16depay = GST_RTP_L16_DEPAY (object);
+
+  gst_rtp_audio_aggregate_clear (&rtpL16depay->aggregate);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_L16_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpL16Depay *rtpL16depay = GST_RTP_L16_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_AGGREGATE_TIME:
+      rtpL16depay->aggregate.aggregate_time = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_L16_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpL16Depay *rtpL16depay = GST_RTP_L16_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_AGGREGATE_TIME:
+      g_value_set_uint64 (value, rtpL16depay->aggregate.aggregate_time);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static gint
@@ -152,6 +242,9 @@ gst_rtp_L16_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
 
   rtpL16depay = GST_RTP_L16_DEPAY (depayload);
 
+  /* pending samples belong to the previous format */
+  gst_rtp_audio_aggregate_push_pending (&rtpL16depay->aggregate);
+
   structure = gst_caps_get_structure (caps, 0);
 
   payload = 96;
@@ -270,7 +363,8 @@ gst_rtp_L16_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
 
   gst_rtp_drop_non_audio_meta (rtpL16depay, outbuf);
 
-  return outbuf;
+  return gst_rtp_audio_aggregate_process (&rtpL16depay->aggregate, rtp,
+      outbuf);
 
   /* ERRORS */
 empty_packet:
@@ -294,3 +388,52 @@ reorder_failed:
     return NULL;
   }
 }
+
+static gboolean
+gst_rtp_L16_depay_handle_event (GstRTPBaseDepayload * filter, GstEvent * event)
+{
+  GstRtpL16Depay *rtpL16depay = GST_RTP_L16_DEPAY (filter);
+  GstFlowReturn ret;
+
+  ret = gst_rtp_audio_aggregate_handle_event (&rtpL16depay->aggregate, event);
+  if (ret != GST_FLOW_OK) {
+    GST_WARNING_OBJECT (rtpL16depay, "failed to push pending samples: %s",
+        gst_flow_get_name (ret));
+    /* still let EOS through so that the pipeline can finish */
+    if (GST_EVENT_TYPE (event) != GST_EVENT_EOS) {
+      gst_event_unref (event);
+      return FALSE;
+    }
+  }
+
+  return
+      GST_RTP_BASE_DEPAYLOAD_CLASS (parent_class)->handle_event (filter, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_L16_depay_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpL16Depay *rtpL16depay = GST_RTP_L16_DEPAY (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_rtp_audio_aggregate_reset (&rtpL16depay->aggregate);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_audio_aggregate_reset (&rtpL16depay->aggregate);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -25,6 +25,7 @@
 #include <gst/audio/audio.h>
 
 #include "gstrtpchannels.h"
+#include "gstrtpaudioaggregate.h"
 
 G_BEGIN_DECLS
 
@@ -50,6 +51,9 @@ struct _GstRtpL16Depay
 
   GstAudioInfo info;
   const GstRTPChannelOrder *order;
+
+  /* packet aggregation */
+  GstRtpAudioAggregate aggregate;
 };
 
 /* Standard definition defining a class for this element. */
@@ -24,6 +24,7 @@
 #include <gst/rtp/gstrtpbaseaudiopayload.h>
 
 #include "gstrtpchannels.h"
+#include "gstrtpaudiopacketlist.h"
 
 G_BEGIN_DECLS
 
@@ -47,6 +48,10 @@ struct _GstRtpL16Pay
 
   GstAudioInfo info;
   const GstRTPChannelOrder *order;
+
+  /* packet-list mode */
+  gboolean packet_list;
+  GstRtpAudioPacketList packetizer;
 };
 
 struct _GstRtpL16PayClass
@@ -69,6 +69,15 @@ GST_STATIC_PAD_TEMPLATE ("sink",
         "encoding-name = (string) \"L24\"")
     );
 
+#define DEFAULT_AGGREGATE_TIME 0
+#define MAX_AGGREGATE_TIME GST_SECOND
+
+enum
+{
+  PROP_0,
+  PROP_AGGREGATE_TIME
+};
+
 #define gst_rtp_L24_depay_parent_class parent_class
 G_DEFINE_TYPE (GstRtpL24Depay, gst_rtp_L24_depay, GST_TYPE_RTP_BASE_DEPAYLOAD);
 GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpL24depay, "rtpL24depay",
@@ -78,18 +87,54 @@ static gboolean gst_rtp_L24_depay_setcaps (GstRTPBaseDepayload * depayload,
     GstCaps * caps);
 static GstBuffer *gst_rtp_L24_depay_process (GstRTPBaseDepayload * depayload,
     GstRTPBuffer * rtp);
+static gboolean gst_rtp_L24_depay_handle_event (GstRTPBaseDepayload * filter,
+    GstEvent * event);
+static GstStateChangeReturn gst_rtp_L24_depay_change_state (GstElement *
+    element, GstStateChange transition);
+static void gst_rtp_L24_depay_finalize (GObject * object);
+static void gst_rtp_L24_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_L24_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static void
 gst_rtp_L24_depay_class_init (GstRtpL24DepayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstRTPBaseDepayloadClass *gstrtpbasedepayload_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasedepayload_class = (GstRTPBaseDepayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_L24_depay_finalize;
+  gobject_class->set_property = gst_rtp_L24_depay_set_property;
+  gobject_class->get_property = gst_rtp_L24_depay_get_property;
+
+  /**
+   * GstRtpL24Depay:aggregate-time:
+   *
+   * Collect the payloads of consecutive packets into output buffers of at
+   * least this duration. Useful for streams with very short packet times,
+   * such as AES67 with 1ms or 125us packets, where pushing one small buffer
+   * per packet is expensive downstream. Pending data is pushed out early
+   * on discontinuities, timestamp gaps, talk spurts and EOS.
+   * 0 disables aggregation.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_AGGREGATE_TIME,
+      g_param_spec_uint64 ("aggregate-time", "Aggregate Time",
+          "Minimum duration of output buffers in nanoseconds "
+          "(0 = one buffer per packet)", 0, MAX_AGGREGATE_TIME,
+          DEFAULT_AGGREGATE_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gstelement_class->change_state = gst_rtp_L24_depay_change_state;
+
   gstrtpbasedepayload_class->set_caps = gst_rtp_L24_depay_setcaps;
   gstrtpbasedepayload_class->process_rtp_packet = gst_rtp_L24_depay_process;
+  gstrtpbasedepayload_class->handle_event = gst_rtp_L24_depay_handle_event;
 
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_rtp_L24_depay_src_template);
@@ -109,6 +154,51 @@ gst_rtp_L24_depay_class_init (GstRtpL24DepayClass * klass)
 static void
 gst_rtp_L24_depay_init (GstRtpL24Depay * rtpL24depay)
 {
+  gst_rtp_audio_aggregate_init (&rtpL24depay->aggregate,
+      GST_RTP_BASE_DEPAYLOAD (rtpL24depay), &rtpL24depay->info);
+  rtpL24depay->aggregate.aggregate_time = DEFAULT_AGGREGATE_TIME;
+}
+
+static void
+gst_rtp_L24_depay_finalize (GObject * object)
+{
+  GstRtpL24Depay *rtpL24depay = GST_RTP_L24_DEPAY (object);
+
+  gst_rtp_audio_aggregate_clear (&rtpL24depay->aggregate);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_L24_depay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpL24Depay *rtpL24depay = GST_RTP_L24_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_AGGREGATE_TIME:
+      rtpL24depay->aggregate.aggregate_time = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_L24_depay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpL24Depay *rtpL24depay = GST_RTP_L24_DEPAY (object);
+
+  switch (prop_id) {
+    case PROP_AGGREGATE_TIME:
+      g_value_set_uint64 (value, rtpL24depay->aggregate.aggregate_time);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static gint
@@ -142,6 +232,9 @@ gst_rtp_L24_depay_setcaps (GstRTPBaseDepayload * depayload, GstCaps * caps)
 
   rtpL24depay = GST_RTP_L24_DEPAY (depayload);
 
+  /* pending samples belong to the previous format */
+  gst_rtp_audio_aggregate_push_pending (&rtpL24depay->aggregate);
+
   structure = gst_caps_get_structure (caps, 0);
 
   payload = 96;
@@ -243,7 +336,8 @@ gst_rtp_L24_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
     goto reorder_failed;
   }
 
-  return outbuf;
+  return gst_rtp_audio_aggregate_process (&rtpL24depay->aggregate, rtp,
+      outbuf);
 
   /* ERRORS */
 empty_packet:
@@ -259,3 +353,52 @@ reorder_failed:
     return NULL;
   }
 }
+
+static gboolean
+gst_rtp_L24_depay_handle_event (GstRTPBaseDepayload * filter, GstEvent * event)
+{
+  GstRtpL24Depay *rtpL24depay = GST_RTP_L24_DEPAY (filter);
+  GstFlowReturn ret;
+
+  ret = gst_rtp_audio_aggregate_handle_event (&rtpL24depay->aggregate, event);
+  if (ret != GST_FLOW_OK) {
+    GST_WARNING_OBJECT (rtpL24depay, "failed to push pending samples: %s",
+        gst_flow_get_name (ret));
+    /* still let EOS through so that the pipeline can finish */
+    if (GST_EVENT_TYPE (event) != GST_EVENT_EOS) {
+      gst_event_unref (event);
+      return FALSE;
+    }
+  }
+
+  return
+      GST_RTP_BASE_DEPAYLOAD_CLASS (parent_class)->handle_event (filter, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_L24_depay_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpL24Depay *rtpL24depay = GST_RTP_L24_DEPAY (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_rtp_audio_aggregate_reset (&rtpL24depay->aggregate);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_audio_aggregate_reset (&rtpL24depay->aggregate);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
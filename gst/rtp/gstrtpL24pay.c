@@ -77,6 +77,23 @@ static GstCaps *gst_rtp_L24_pay_getcaps (GstRTPBasePayload * rtppayload,
 static GstFlowReturn
 gst_rtp_L24_pay_handle_buffer (GstRTPBasePayload * basepayload,
     GstBuffer * buffer);
+static gboolean gst_rtp_L24_pay_sink_event (GstRTPBasePayload * payload,
+    GstEvent * event);
+static GstStateChangeReturn gst_rtp_L24_pay_change_state (GstElement *
+    element, GstStateChange transition);
+static void gst_rtp_L24_pay_finalize (GObject * object);
+static void gst_rtp_L24_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_L24_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+#define DEFAULT_PACKET_LIST FALSE
+
+enum
+{
+  PROP_0,
+  PROP_PACKET_LIST
+};
 
 #define gst_rtp_L24_pay_parent_class parent_class
 G_DEFINE_TYPE (GstRtpL24Pay, gst_rtp_L24_pay, GST_TYPE_RTP_BASE_AUDIO_PAYLOAD);
@@ -86,15 +103,44 @@ GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpL24pay, "rtpL24pay",
 static void
 gst_rtp_L24_pay_class_init (GstRtpL24PayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstRTPBasePayloadClass *gstrtpbasepayload_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
   gstrtpbasepayload_class = (GstRTPBasePayloadClass *) klass;
 
+  gobject_class->finalize = gst_rtp_L24_pay_finalize;
+  gobject_class->set_property = gst_rtp_L24_pay_set_property;
+  gobject_class->get_property = gst_rtp_L24_pay_get_property;
+
+  /**
+   * GstRtpL24Pay:packet-list:
+   *
+   * Cut every input buffer into packets of exactly max-ptime (or the ptime
+   * from the caps, or as much as fits into the MTU) and push them downstream
+   * as one buffer list. The payload of each packet references the input
+   * memory instead of going through an adapter, only samples that do not
+   * fill a complete packet are kept until the next buffer. This is meant for
+   * streams with very short packet times, such as AES67 or ST 2110-30 with
+   * 1ms or 125us packets, where pushing every packet on its own is expensive.
+   * min-ptime and ptime-multiple are ignored in this mode.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_PACKET_LIST,
+      g_param_spec_boolean ("packet-list", "Packet List",
+          "Packetize into fixed packet times and push one buffer list "
+          "per input buffer", DEFAULT_PACKET_LIST,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gstelement_class->change_state = gst_rtp_L24_pay_change_state;
+
   gstrtpbasepayload_class->set_caps = gst_rtp_L24_pay_setcaps;
   gstrtpbasepayload_class->get_caps = gst_rtp_L24_pay_getcaps;
   gstrtpbasepayload_class->handle_buffer = gst_rtp_L24_pay_handle_buffer;
+  gstrtpbasepayload_class->sink_event = gst_rtp_L24_pay_sink_event;
 
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_rtp_L24_pay_src_template);
@@ -120,6 +166,52 @@ gst_rtp_L24_pay_init (GstRtpL24Pay * rtpL24pay)
 
   /* tell rtpbaseaudiopayload that this is a sample based codec */
   gst_rtp_base_audio_payload_set_sample_based (rtpbaseaudiopayload);
+
+  rtpL24pay->packet_list = DEFAULT_PACKET_LIST;
+  gst_rtp_audio_packet_list_init (&rtpL24pay->packetizer,
+      GST_RTP_BASE_PAYLOAD (rtpL24pay), &rtpL24pay->info);
+}
+
+static void
+gst_rtp_L24_pay_finalize (GObject * object)
+{
+  GstRtpL24Pay *rtpL24pay = GST_RTP_L24_PAY (object);
+
+  gst_rtp_audio_packet_list_clear (&rtpL24pay->packetizer);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_L24_pay_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpL24Pay *rtpL24pay = GST_RTP_L24_PAY (object);
+
+  switch (prop_id) {
+    case PROP_PACKET_LIST:
+      rtpL24pay->packet_list = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_L24_pay_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpL24Pay *rtpL24pay = GST_RTP_L24_PAY (object);
+
+  switch (prop_id) {
+    case PROP_PACKET_LIST:
+      g_value_set_boolean (value, rtpL24pay->packet_list);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static gboolean
@@ -135,6 +227,9 @@ gst_rtp_L24_pay_setcaps (GstRTPBasePayload * basepayload, GstCaps * caps)
   rtpbaseaudiopayload = GST_RTP_BASE_AUDIO_PAYLOAD (basepayload);
   rtpL24pay = GST_RTP_L24_PAY (basepayload);
 
+  /* pending samples belong to the previous format */
+  gst_rtp_audio_packet_list_flush (&rtpL24pay->packetizer);
+
   info = &rtpL24pay->info;
   gst_audio_info_init (info);
   if (!gst_audio_info_from_caps (info, caps))
@@ -224,6 +319,7 @@ gst_rtp_L24_pay_handle_buffer (GstRTPBasePayload * basepayload,
     GstBuffer * buffer)
 {
   GstRtpL24Pay *rtpL24pay;
+  GstFlowReturn ret;
 
   rtpL24pay = GST_RTP_L24_PAY (basepayload);
   buffer = gst_buffer_make_writable (buffer);
@@ -232,9 +328,62 @@ gst_rtp_L24_pay_handle_buffer (GstRTPBasePayload * basepayload,
       !gst_audio_buffer_reorder_channels (buffer, rtpL24pay->info.finfo->format,
           rtpL24pay->info.channels, rtpL24pay->info.position,
           rtpL24pay->order->pos)) {
+    gst_buffer_unref (buffer);
     return GST_FLOW_ERROR;
   }
 
+  if (rtpL24pay->packet_list)
+    return gst_rtp_audio_packet_list_push (&rtpL24pay->packetizer, buffer);
+
+  /* packet-list was switched off, don't leave samples behind */
+  ret = gst_rtp_audio_packet_list_flush (&rtpL24pay->packetizer);
+  if (ret != GST_FLOW_OK) {
+    gst_buffer_unref (buffer);
+    return ret;
+  }
+
   return GST_RTP_BASE_PAYLOAD_CLASS (parent_class)->handle_buffer (basepayload,
       buffer);
 }
+
+static gboolean
+gst_rtp_L24_pay_sink_event (GstRTPBasePayload * payload, GstEvent * event)
+{
+  GstRtpL24Pay *rtpL24pay = GST_RTP_L24_PAY (payload);
+  GstFlowReturn ret;
+
+  ret = gst_rtp_audio_packet_list_handle_event (&rtpL24pay->packetizer, event);
+  if (ret != GST_FLOW_OK)
+    GST_WARNING_OBJECT (rtpL24pay, "failed to push pending samples: %s",
+        gst_flow_get_name (ret));
+
+  return GST_RTP_BASE_PAYLOAD_CLASS (parent_class)->sink_event (payload,
+      event);
+}
+
+static GstStateChangeReturn
+gst_rtp_L24_pay_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpL24Pay *rtpL24pay = GST_RTP_L24_PAY (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_rtp_audio_packet_list_reset (&rtpL24pay->packetizer);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_audio_packet_list_reset (&rtpL24pay->packetizer);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,185 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstrtpaudioaggregate.h"
+
+void
+gst_rtp_audio_aggregate_init (GstRtpAudioAggregate * agg,
+    GstRTPBaseDepayload * depayload, const GstAudioInfo * info)
+{
+  agg->depayload = depayload;
+  agg->info = info;
+  agg->aggregate_time = 0;
+  agg->adapter = gst_adapter_new ();
+  gst_rtp_audio_aggregate_reset (agg);
+}
+
+void
+gst_rtp_audio_aggregate_clear (GstRtpAudioAggregate * agg)
+{
+  g_clear_object (&agg->adapter);
+}
+
+void
+gst_rtp_audio_aggregate_reset (GstRtpAudioAggregate * agg)
+{
+  gst_adapter_clear (agg->adapter);
+  agg->pending_pts = GST_CLOCK_TIME_NONE;
+  agg->pending_dts = GST_CLOCK_TIME_NONE;
+  agg->pending_discont = FALSE;
+  agg->pending_resync = FALSE;
+}
+
+/* takes all aggregated samples out of the adapter as one buffer, timestamped
+ * with the first packet that went into it */
+static GstBuffer *
+gst_rtp_audio_aggregate_take_pending (GstRtpAudioAggregate * agg)
+{
+  GstBuffer *outbuf;
+  guint avail;
+
+  avail = gst_adapter_available (agg->adapter);
+  if (avail == 0)
+    return NULL;
+
+  outbuf = gst_adapter_take_buffer (agg->adapter, avail);
+  outbuf = gst_buffer_make_writable (outbuf);
+
+  GST_BUFFER_PTS (outbuf) = agg->pending_pts;
+  GST_BUFFER_DTS (outbuf) = agg->pending_dts;
+  GST_BUFFER_DURATION (outbuf) =
+      gst_util_uint64_scale_int (avail / agg->info->bpf, GST_SECOND,
+      agg->info->rate);
+  if (agg->pending_discont)
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+  else
+    GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_DISCONT);
+  if (agg->pending_resync)
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_RESYNC);
+
+  GST_LOG_OBJECT (agg->depayload, "taking %u bytes, pts %" GST_TIME_FORMAT
+      ", duration %" GST_TIME_FORMAT, avail,
+      GST_TIME_ARGS (GST_BUFFER_PTS (outbuf)),
+      GST_TIME_ARGS (GST_BUFFER_DURATION (outbuf)));
+
+  agg->pending_discont = FALSE;
+  agg->pending_resync = FALSE;
+
+  return outbuf;
+}
+
+GstFlowReturn
+gst_rtp_audio_aggregate_push_pending (GstRtpAudioAggregate * agg)
+{
+  GstBuffer *outbuf;
+
+  outbuf = gst_rtp_audio_aggregate_take_pending (agg);
+  if (outbuf == NULL)
+    return GST_FLOW_OK;
+
+  return gst_rtp_base_depayload_push (agg->depayload, outbuf);
+}
+
+/* collects the payload of one packet, returns a buffer once aggregate-time
+ * worth of samples is pending. Without aggregation @outbuf is returned as
+ * is */
+GstBuffer *
+gst_rtp_audio_aggregate_process (GstRtpAudioAggregate * agg,
+    GstRTPBuffer * rtp, GstBuffer * outbuf)
+{
+  const GstAudioInfo *info = agg->info;
+  guint32 rtptime;
+  guint64 threshold;
+  gsize size;
+  guint avail;
+
+  avail = gst_adapter_available (agg->adapter);
+  if (agg->aggregate_time == 0 && avail == 0)
+    return outbuf;
+
+  rtptime = gst_rtp_buffer_get_timestamp (rtp);
+  size = gst_buffer_get_size (outbuf);
+
+  /* never glue data across a gap, the pending data would end up with wrong
+   * timestamps */
+  if (avail > 0 && (GST_BUFFER_IS_DISCONT (rtp->buffer) ||
+          GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_RESYNC) ||
+          rtptime != agg->next_rtptime)) {
+    GstFlowReturn ret;
+
+    GST_DEBUG_OBJECT (agg->depayload,
+        "discontinuity, pushing %u pending bytes", avail);
+    /* the base class puts the DISCONT flag of the packet on this data as
+     * well, pending_discont keeps it for the data after the gap */
+    ret = gst_rtp_audio_aggregate_push_pending (agg);
+    if (ret != GST_FLOW_OK) {
+      GST_WARNING_OBJECT (agg->depayload,
+          "failed to push pending samples: %s", gst_flow_get_name (ret));
+      gst_buffer_unref (outbuf);
+      return NULL;
+    }
+    avail = 0;
+  }
+
+  if (avail == 0) {
+    agg->pending_pts = GST_BUFFER_PTS (rtp->buffer);
+    agg->pending_dts = GST_BUFFER_DTS (rtp->buffer);
+    agg->pending_discont = GST_BUFFER_IS_DISCONT (rtp->buffer);
+    agg->pending_resync =
+        GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_RESYNC);
+  }
+
+  agg->next_rtptime = rtptime + size / info->bpf;
+  gst_adapter_push (agg->adapter, outbuf);
+  avail += size;
+
+  threshold = gst_util_uint64_scale_int (agg->aggregate_time, info->rate,
+      GST_SECOND) * info->bpf;
+  if (avail < threshold)
+    return NULL;
+
+  return gst_rtp_audio_aggregate_take_pending (agg);
+}
+
+/* pushes pending data before EOS, SEGMENT and GAP events so that it is not
+ * sent after them, and drops it on flushes */
+GstFlowReturn
+gst_rtp_audio_aggregate_handle_event (GstRtpAudioAggregate * agg,
+    GstEvent * event)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+    case GST_EVENT_SEGMENT:
+    case GST_EVENT_GAP:
+      ret = gst_rtp_audio_aggregate_push_pending (agg);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_rtp_audio_aggregate_reset (agg);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
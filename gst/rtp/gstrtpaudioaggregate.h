@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_AUDIO_AGGREGATE_H__
+#define __GST_RTP_AUDIO_AGGREGATE_H__
+
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbasedepayload.h>
+#include <gst/audio/audio.h>
+#include <gst/base/gstadapter.h>
+
+G_BEGIN_DECLS
+
+/* Collects the payloads of consecutive raw audio packets of a depayloader
+ * into buffers of at least aggregate_time */
+typedef struct
+{
+  GstRTPBaseDepayload *depayload;
+  const GstAudioInfo *info;
+
+  GstClockTime aggregate_time;
+  GstAdapter *adapter;
+  GstClockTime pending_pts;
+  GstClockTime pending_dts;
+  gboolean pending_discont;
+  gboolean pending_resync;
+  guint32 next_rtptime;
+} GstRtpAudioAggregate;
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_aggregate_init (GstRtpAudioAggregate * agg,
+    GstRTPBaseDepayload * depayload, const GstAudioInfo * info);
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_aggregate_clear (GstRtpAudioAggregate * agg);
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_aggregate_reset (GstRtpAudioAggregate * agg);
+
+G_GNUC_INTERNAL
+GstFlowReturn gst_rtp_audio_aggregate_push_pending (GstRtpAudioAggregate * agg);
+
+G_GNUC_INTERNAL
+GstBuffer * gst_rtp_audio_aggregate_process (GstRtpAudioAggregate * agg,
+    GstRTPBuffer * rtp, GstBuffer * outbuf);
+
+G_GNUC_INTERNAL
+GstFlowReturn gst_rtp_audio_aggregate_handle_event (
+    GstRtpAudioAggregate * agg, GstEvent * event);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_AUDIO_AGGREGATE_H__ */
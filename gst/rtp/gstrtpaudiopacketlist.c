@@ -0,0 +1,273 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpaudiopacketlist.h"
+#include "gstrtputils.h"
+
+void
+gst_rtp_audio_packet_list_init (GstRtpAudioPacketList * pl,
+    GstRTPBasePayload * payload, const GstAudioInfo * info)
+{
+  pl->payload = payload;
+  pl->info = info;
+  pl->adapter = gst_adapter_new ();
+  gst_rtp_audio_packet_list_reset (pl);
+}
+
+void
+gst_rtp_audio_packet_list_clear (GstRtpAudioPacketList * pl)
+{
+  g_clear_object (&pl->adapter);
+}
+
+void
+gst_rtp_audio_packet_list_reset (GstRtpAudioPacketList * pl)
+{
+  gst_adapter_clear (pl->adapter);
+  pl->discont = TRUE;
+  pl->offset = 0;
+  pl->base_pts = GST_CLOCK_TIME_NONE;
+  pl->base_offset = 0;
+}
+
+/* number of payload bytes in one packet: as many samples as fit into the MTU,
+ * limited by max-ptime and the ptime from the caps */
+static guint
+gst_rtp_audio_packet_list_get_packet_len (GstRtpAudioPacketList * pl)
+{
+  GstRTPBasePayload *basepayload = pl->payload;
+  const GstAudioInfo *info = pl->info;
+  guint64 len;
+
+  len = gst_rtp_buffer_calc_payload_len (GST_RTP_BASE_PAYLOAD_MTU
+      (basepayload), 0, 0);
+  if (basepayload->max_ptime != -1)
+    len = MIN (len, gst_util_uint64_scale_int (basepayload->max_ptime,
+            info->rate, GST_SECOND) * info->bpf);
+  if (basepayload->ptime)
+    len = MIN (len, gst_util_uint64_scale_int (basepayload->ptime,
+            info->rate, GST_SECOND) * info->bpf);
+
+  len -= len % info->bpf;
+
+  return MAX (len, info->bpf);
+}
+
+/* creates a header-only packet for the next payload_len bytes of audio */
+static GstBuffer *
+gst_rtp_audio_packet_list_new_packet (GstRtpAudioPacketList * pl,
+    guint payload_len)
+{
+  const GstAudioInfo *info = pl->info;
+  GstBuffer *outbuf;
+  guint samples;
+
+  samples = payload_len / info->bpf;
+
+  outbuf = gst_rtp_base_payload_allocate_output_buffer (pl->payload, 0, 0, 0);
+
+  /* the offset is in RTP time, the base class uses it for perfect
+   * timestamps */
+  GST_BUFFER_OFFSET (outbuf) = pl->offset;
+  if (GST_CLOCK_TIME_IS_VALID (pl->base_pts)) {
+    GstClockTime diff;
+
+    /* samples pending from before the sync point come before it */
+    if (pl->offset >= pl->base_offset) {
+      diff = gst_util_uint64_scale_int (pl->offset - pl->base_offset,
+          GST_SECOND, info->rate);
+      GST_BUFFER_PTS (outbuf) = pl->base_pts + diff;
+    } else {
+      diff = gst_util_uint64_scale_int (pl->base_offset - pl->offset,
+          GST_SECOND, info->rate);
+      GST_BUFFER_PTS (outbuf) = pl->base_pts > diff ? pl->base_pts - diff : 0;
+    }
+  }
+  GST_BUFFER_DURATION (outbuf) =
+      gst_util_uint64_scale_int (samples, GST_SECOND, info->rate);
+
+  if (pl->discont) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    /* mark the first packet after a discont like rtpbaseaudiopayload */
+    gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_marker (&rtp, TRUE);
+    gst_rtp_buffer_unmap (&rtp);
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    pl->discont = FALSE;
+  }
+
+  pl->offset += samples;
+
+  return outbuf;
+}
+
+/* pushes the samples that did not fill a complete packet */
+GstFlowReturn
+gst_rtp_audio_packet_list_flush (GstRtpAudioPacketList * pl)
+{
+  GstBuffer *outbuf, *paybuf;
+  guint avail;
+
+  avail = gst_adapter_available (pl->adapter);
+  if (avail == 0)
+    return GST_FLOW_OK;
+
+  GST_DEBUG_OBJECT (pl->payload, "flushing %u bytes", avail);
+
+  paybuf = gst_adapter_take_buffer_fast (pl->adapter, avail);
+  outbuf = gst_rtp_audio_packet_list_new_packet (pl, avail);
+  gst_rtp_copy_audio_meta (pl->payload, outbuf, paybuf);
+  outbuf = gst_buffer_append (outbuf, paybuf);
+
+  return gst_rtp_base_payload_push (pl->payload, outbuf);
+}
+
+/* cuts @buffer into packets and pushes them as one buffer list, samples that
+ * don't fill a complete packet are kept for the next buffer */
+GstFlowReturn
+gst_rtp_audio_packet_list_push (GstRtpAudioPacketList * pl, GstBuffer * buffer)
+{
+  const GstAudioInfo *info = pl->info;
+  GstBufferList *list;
+  GstBuffer *outbuf, *paybuf;
+  GstClockTime pts;
+  GstFlowReturn ret;
+  guint packet_len, avail;
+  gsize size, pos;
+
+  size = gst_buffer_get_size (buffer);
+  pts = GST_BUFFER_PTS (buffer);
+
+  if (size % info->bpf != 0)
+    goto wrong_size;
+
+  if (GST_BUFFER_IS_DISCONT (buffer)) {
+    ret = gst_rtp_audio_packet_list_flush (pl);
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_unref (buffer);
+      return ret;
+    }
+
+    /* keep the RTP timestamps in line with the gap */
+    if (GST_CLOCK_TIME_IS_VALID (pts) &&
+        GST_CLOCK_TIME_IS_VALID (pl->base_pts) && pts > pl->base_pts)
+      pl->offset = pl->base_offset +
+          gst_util_uint64_scale_int (pts - pl->base_pts, info->rate,
+          GST_SECOND);
+    pl->base_pts = GST_CLOCK_TIME_NONE;
+    pl->discont = TRUE;
+  }
+
+  packet_len = gst_rtp_audio_packet_list_get_packet_len (pl);
+  avail = gst_adapter_available (pl->adapter);
+
+  /* packet timestamps are interpolated from the last timestamp we synced
+   * to, the first sample of this buffer comes after the pending ones */
+  if (!GST_CLOCK_TIME_IS_VALID (pl->base_pts) &&
+      GST_CLOCK_TIME_IS_VALID (pts)) {
+    pl->base_pts = pts;
+    pl->base_offset = pl->offset + avail / info->bpf;
+  }
+
+  if (avail + size < packet_len) {
+    gst_adapter_push (pl->adapter, buffer);
+    return GST_FLOW_OK;
+  }
+
+  list = gst_buffer_list_new_sized ((avail + size) / packet_len);
+  pos = 0;
+
+  /* the packet size shrinks when mtu or max-ptime are lowered while samples
+   * are pending, these make up complete packets on their own then */
+  while (avail >= packet_len) {
+    paybuf = gst_adapter_take_buffer_fast (pl->adapter, packet_len);
+    outbuf = gst_rtp_audio_packet_list_new_packet (pl, packet_len);
+    gst_rtp_copy_audio_meta (pl->payload, outbuf, paybuf);
+    outbuf = gst_buffer_append (outbuf, paybuf);
+    gst_buffer_list_add (list, outbuf);
+    avail -= packet_len;
+  }
+
+  /* complete the packet that was started with the previous buffer */
+  if (avail > 0) {
+    paybuf = gst_adapter_take_buffer_fast (pl->adapter, avail);
+    pos = packet_len - avail;
+
+    outbuf = gst_rtp_audio_packet_list_new_packet (pl, packet_len);
+    gst_rtp_copy_audio_meta (pl->payload, outbuf, buffer);
+    outbuf = gst_buffer_append (outbuf, paybuf);
+    gst_buffer_copy_into (outbuf, buffer, GST_BUFFER_COPY_MEMORY, 0, pos);
+    gst_buffer_list_add (list, outbuf);
+  }
+
+  while (size - pos >= packet_len) {
+    outbuf = gst_rtp_audio_packet_list_new_packet (pl, packet_len);
+    gst_rtp_copy_audio_meta (pl->payload, outbuf, buffer);
+    gst_buffer_copy_into (outbuf, buffer, GST_BUFFER_COPY_MEMORY, pos,
+        packet_len);
+    gst_buffer_list_add (list, outbuf);
+    pos += packet_len;
+  }
+
+  if (pos < size)
+    gst_adapter_push (pl->adapter, gst_buffer_copy_region (buffer,
+            GST_BUFFER_COPY_MEMORY, pos, size - pos));
+
+  gst_buffer_unref (buffer);
+
+  return gst_rtp_base_payload_push_list (pl->payload, list);
+
+  /* ERRORS */
+wrong_size:
+  {
+    GST_ELEMENT_WARNING (pl->payload, STREAM, FORMAT, (NULL),
+        ("Buffer size %" G_GSIZE_FORMAT " is not a multiple of the frame "
+            "size %d", size, info->bpf));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+}
+
+/* pushes the remaining samples on EOS and drops them on flushes, returns
+ * the result of pushing them */
+GstFlowReturn
+gst_rtp_audio_packet_list_handle_event (GstRtpAudioPacketList * pl,
+    GstEvent * event)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      ret = gst_rtp_audio_packet_list_flush (pl);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_rtp_audio_packet_list_reset (pl);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,67 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_AUDIO_PACKET_LIST_H__
+#define __GST_RTP_AUDIO_PACKET_LIST_H__
+
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbasepayload.h>
+#include <gst/audio/audio.h>
+#include <gst/base/gstadapter.h>
+
+G_BEGIN_DECLS
+
+/* Cuts raw audio into packets of a fixed duration for a payloader and
+ * pushes the packets of each input buffer as one buffer list */
+typedef struct
+{
+  GstRTPBasePayload *payload;
+  const GstAudioInfo *info;
+
+  GstAdapter *adapter;
+  gboolean discont;
+  guint64 offset;
+  GstClockTime base_pts;
+  guint64 base_offset;
+} GstRtpAudioPacketList;
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_packet_list_init (GstRtpAudioPacketList * pl,
+    GstRTPBasePayload * payload, const GstAudioInfo * info);
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_packet_list_clear (GstRtpAudioPacketList * pl);
+
+G_GNUC_INTERNAL
+void gst_rtp_audio_packet_list_reset (GstRtpAudioPacketList * pl);
+
+G_GNUC_INTERNAL
+GstFlowReturn gst_rtp_audio_packet_list_flush (GstRtpAudioPacketList * pl);
+
+G_GNUC_INTERNAL
+GstFlowReturn gst_rtp_audio_packet_list_push (GstRtpAudioPacketList * pl,
+    GstBuffer * buffer);
+
+G_GNUC_INTERNAL
+GstFlowReturn
+gst_rtp_audio_packet_list_handle_event (GstRtpAudioPacketList * pl,
+    GstEvent * event);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_AUDIO_PACKET_LIST_H__ */
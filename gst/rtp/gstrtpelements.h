@@ -120,6 +120,7 @@ GST_ELEMENT_REGISTER_DECLARE (rtpvrawdepay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvrawpay);
 GST_ELEMENT_REGISTER_DECLARE (rtpstreampay);
 GST_ELEMENT_REGISTER_DECLARE (rtpstreamdepay);
+GST_ELEMENT_REGISTER_DECLARE (rtptemporalfilter);
 GST_ELEMENT_REGISTER_DECLARE (rtpisacpay);
 GST_ELEMENT_REGISTER_DECLARE (rtpisacdepay);
 GST_ELEMENT_REGISTER_DECLARE (rtpredenc);
@@ -67,6 +67,8 @@ static GstCaps *gst_rtp_stream_depay_get_sink_caps (GstBaseParse * parse,
     GstCaps * filter);
 static GstFlowReturn gst_rtp_stream_depay_handle_frame (GstBaseParse * parse,
     GstBaseParseFrame * frame, gint * skipsize);
+static GstFlowReturn gst_rtp_stream_depay_pre_push_frame (GstBaseParse *
+    parse, GstBaseParseFrame * frame);
 
 static gboolean gst_rtp_stream_depay_sink_activate (GstPad * pad,
     GstObject * parent);
@@ -94,6 +96,8 @@ gst_rtp_stream_depay_class_init (GstRtpStreamDepayClass * klass)
       GST_DEBUG_FUNCPTR (gst_rtp_stream_depay_get_sink_caps);
   parse_class->handle_frame =
       GST_DEBUG_FUNCPTR (gst_rtp_stream_depay_handle_frame);
+  parse_class->pre_push_frame =
+      GST_DEBUG_FUNCPTR (gst_rtp_stream_depay_pre_push_frame);
 }
 
 static void
@@ -180,6 +184,7 @@ gst_rtp_stream_depay_get_sink_caps (GstBaseParse * parse, GstCaps * filter)
 
     res = gst_caps_intersect_full (peercaps, templ, GST_CAPS_INTERSECT_FIRST);
     gst_caps_unref (peercaps);
+    gst_caps_unref (templ);
   } else {
     res = templ;
   }
@@ -198,27 +203,98 @@ gst_rtp_stream_depay_get_sink_caps (GstBaseParse * parse, GstCaps * filter)
   return res;
 }
 
+/* Splits off all complete packets that are available in one pass. The first
+ * packet becomes the frame, the others are collected in a buffer list that
+ * is pushed together with it from pre_push_frame() */
 static GstFlowReturn
 gst_rtp_stream_depay_handle_frame (GstBaseParse * parse,
     GstBaseParseFrame * frame, gint * skipsize)
 {
-  gsize buf_size;
+  GstRtpStreamDepay *self = GST_RTP_STREAM_DEPAY (parse);
+  GstFlowReturn ret;
+  GstMapInfo map;
+  gsize offset = 0;
   guint16 size;
 
-  if (gst_buffer_extract (frame->buffer, 0, &size, 2) != 2)
+  if (!gst_buffer_map (frame->buffer, &map, GST_MAP_READ))
     return GST_FLOW_ERROR;
 
-  size = GUINT16_FROM_BE (size);
-  buf_size = gst_buffer_get_size (frame->buffer);
+  while (offset + 2 <= map.size) {
+    GstBuffer *outbuf;
 
-  /* Need more data */
-  if (size + 2 > buf_size)
+    size = GST_READ_UINT16_BE (map.data + offset);
+
+    /* Need more data */
+    if (offset + 2 + size > map.size)
+      break;
+
+    outbuf = gst_buffer_copy_region (frame->buffer, GST_BUFFER_COPY_ALL,
+        offset + 2, size);
+
+    if (offset == 0) {
+      frame->out_buffer = outbuf;
+    } else {
+      /* in reverse playback frames are queued and pushed later, only the
+       * first packet is handled then */
+      if (parse->segment.rate < 0.0) {
+        gst_buffer_unref (outbuf);
+        break;
+      }
+
+      if (self->list == NULL)
+        self->list = gst_buffer_list_new ();
+      GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_DISCONT);
+      gst_buffer_list_add (self->list, outbuf);
+    }
+
+    offset += size + 2;
+  }
+
+  gst_buffer_unmap (frame->buffer, &map);
+
+  if (offset == 0)
+    return GST_FLOW_OK;
+
+  GST_LOG_OBJECT (self, "finishing %" G_GSIZE_FORMAT " bytes with %u packets",
+      offset, self->list ? gst_buffer_list_length (self->list) + 1 : 1);
+
+  self->list_ret = GST_FLOW_OK;
+  ret = gst_base_parse_finish_frame (parse, frame, offset);
+
+  /* frame was not pushed */
+  if (self->list) {
+    GST_DEBUG_OBJECT (self, "dropping %u packets",
+        gst_buffer_list_length (self->list));
+    gst_buffer_list_unref (self->list);
+    self->list = NULL;
+  }
+
+  if (ret == GST_FLOW_OK)
+    ret = self->list_ret;
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_stream_depay_pre_push_frame (GstBaseParse * parse,
+    GstBaseParseFrame * frame)
+{
+  GstRtpStreamDepay *self = GST_RTP_STREAM_DEPAY (parse);
+  GstBufferList *list;
+  GstBuffer *buffer;
+
+  if (self->list == NULL)
     return GST_FLOW_OK;
 
-  frame->out_buffer =
-      gst_buffer_copy_region (frame->buffer, GST_BUFFER_COPY_ALL, 2, size);
+  list = self->list;
+  self->list = NULL;
+
+  buffer = frame->out_buffer ? frame->out_buffer : frame->buffer;
+  gst_buffer_list_insert (list, 0, gst_buffer_ref (buffer));
+
+  self->list_ret = gst_pad_push_list (GST_BASE_PARSE_SRC_PAD (parse), list);
 
-  return gst_base_parse_finish_frame (parse, frame, size + 2);
+  return GST_BASE_PARSE_FLOW_DROPPED;
 }
 
 static gboolean
@@ -42,6 +42,10 @@ typedef struct _GstRtpStreamDepayClass GstRtpStreamDepayClass;
 struct _GstRtpStreamDepay
 {
   GstBaseParse parent;
+
+  /* packets following the current frame in the same input */
+  GstBufferList *list;
+  GstFlowReturn list_ret;
 };
 
 struct _GstRtpStreamDepayClass
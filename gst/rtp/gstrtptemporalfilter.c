@@ -0,0 +1,486 @@
+/* GStreamer
+ * Copyright (C) <2021> The GStreamer project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtptemporalfilter
+ * @title: rtptemporalfilter
+ * @short_description: Drop temporal layers of an RTP video stream
+ *
+ * Forwards only the temporal layers up to
+ * #GstRtpTemporalFilter:max-temporal-layer of a temporally scalable RTP video
+ * stream, without depayloading or decoding it. This allows a selective
+ * forwarding unit to adapt the bitrate sent to each receiver.
+ *
+ * The temporal layer of a packet is taken from the frame marking RTP header
+ * extension if #GstRtpTemporalFilter:frame-marking-ext-id is set, which works
+ * for any codec, e.g. H.264. Otherwise, for VP8 streams the layer is read from
+ * the VP8 payload descriptor.
+ *
+ * Sequence numbers and VP8 picture IDs of the forwarded packets are rewritten
+ * so that they stay continuous, which means packets should arrive in order,
+ * e.g. after a #GstRtpJitterBuffer. Lowering the maximum layer takes effect on
+ * the next frame, raising it waits for a frame that can be decoded from the
+ * base layer only, or for a key frame.
+ *
+ * ## Example pipeline
+ *
+ * |[
+ * gst-launch-1.0 udpsrc port=5000 caps="application/x-rtp, media=video, clock-rate=90000, encoding-name=VP8" ! rtpjitterbuffer ! rtptemporalfilter max-temporal-layer=0 ! udpsink host=127.0.0.1 port=5002
+ * ]| This forwards only the base layer of a VP8 stream.
+ *
+ * Since: 1.20
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpelements.h"
+#include "gstrtptemporalfilter.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_temporal_filter_debug);
+#define GST_CAT_DEFAULT gst_rtp_temporal_filter_debug
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, media = (string) video"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, media = (string) video"));
+
+#define MAX_TEMPORAL_LAYER              7
+#define DEFAULT_MAX_TEMPORAL_LAYER      MAX_TEMPORAL_LAYER
+#define DEFAULT_FRAME_MARKING_EXT_ID    0
+
+enum
+{
+  PROP_0,
+  PROP_MAX_TEMPORAL_LAYER,
+  PROP_FRAME_MARKING_EXT_ID,
+  PROP_DROPPED
+};
+
+/* Layer information of a packet */
+typedef struct
+{
+  /* first packet of a frame */
+  gboolean start;
+  gboolean keyframe;
+  /* frame only depends on the base layer */
+  gboolean sync;
+  guint tid;
+
+  /* offset of the VP8 picture ID in the payload and its size in bits,
+   * or 0 if there is none */
+  guint picture_id_offset;
+  guint picture_id_bits;
+} RtpLayerInfo;
+
+#define gst_rtp_temporal_filter_parent_class parent_class
+G_DEFINE_TYPE (GstRtpTemporalFilter, gst_rtp_temporal_filter,
+    GST_TYPE_ELEMENT);
+GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtptemporalfilter, "rtptemporalfilter",
+    GST_RANK_NONE, GST_TYPE_RTP_TEMPORAL_FILTER, rtp_element_init (plugin));
+
+static void
+gst_rtp_temporal_filter_reset (GstRtpTemporalFilter * self)
+{
+  GST_OBJECT_LOCK (self);
+  self->cur_layer = self->max_temporal_layer;
+  GST_OBJECT_UNLOCK (self);
+  self->drop_frame = FALSE;
+  self->seqnum_offset = 0;
+  self->picture_id_offset = 0;
+}
+
+/* draft-ietf-avtext-framemarking: S|E|I|D|B|TID, followed by LID and
+ * TL0PICIDX for scalable streams */
+static gboolean
+parse_frame_marking (GstRTPBuffer * rtp, guint8 ext_id, RtpLayerInfo * info)
+{
+  guint8 *data;
+  guint size;
+
+  if (!gst_rtp_buffer_get_extension_onebyte_header (rtp, ext_id, 0,
+          (gpointer *) & data, &size) || size < 1)
+    return FALSE;
+
+  info->start = (data[0] & 0x80) != 0;
+  info->keyframe = (data[0] & 0x20) != 0;
+
+  if (size >= 3) {
+    info->tid = data[0] & 0x07;
+    info->sync = info->tid == 0 || (data[0] & 0x08) != 0;
+  } else {
+    info->tid = 0;
+    info->sync = TRUE;
+  }
+
+  return TRUE;
+}
+
+/* RFC 7741 section 4.2 */
+static gboolean
+parse_vp8_descriptor (GstRTPBuffer * rtp, RtpLayerInfo * info)
+{
+  guint8 *data;
+  guint size, offset = 1;
+
+  data = gst_rtp_buffer_get_payload (rtp);
+  size = gst_rtp_buffer_get_payload_len (rtp);
+
+  if (size < 1)
+    goto invalid;
+
+  /* S bit and partition index 0 */
+  info->start = (data[0] & 0x17) == 0x10;
+  info->tid = 0;
+  info->sync = TRUE;
+
+  /* X bit */
+  if (data[0] & 0x80) {
+    guint8 x;
+
+    if (size < 2)
+      goto invalid;
+    x = data[1];
+    offset++;
+
+    /* I bit, picture ID */
+    if (x & 0x80) {
+      if (offset >= size)
+        goto invalid;
+      info->picture_id_offset = offset;
+      if (data[offset] & 0x80) {
+        info->picture_id_bits = 15;
+        offset += 2;
+      } else {
+        info->picture_id_bits = 7;
+        offset++;
+      }
+    }
+    /* L bit, TL0PICIDX */
+    if (x & 0x40)
+      offset++;
+    /* T or K bit, TID|Y|KEYIDX */
+    if (x & 0x30) {
+      if (offset >= size)
+        goto invalid;
+      if (x & 0x20) {
+        info->tid = data[offset] >> 6;
+        info->sync = info->tid == 0 || (data[offset] & 0x20) != 0;
+      }
+      offset++;
+    }
+  }
+
+  if (offset >= size)
+    goto invalid;
+
+  /* inverse key frame flag of the VP8 payload header */
+  info->keyframe = info->start && (data[offset] & 0x01) == 0;
+
+  return TRUE;
+
+invalid:
+  {
+    info->picture_id_offset = 0;
+    info->picture_id_bits = 0;
+    return FALSE;
+  }
+}
+
+static void
+rewrite_picture_id (GstRTPBuffer * rtp, RtpLayerInfo * info, guint16 offset)
+{
+  guint8 *data = gst_rtp_buffer_get_payload (rtp);
+  guint8 *p = &data[info->picture_id_offset];
+
+  if (info->picture_id_bits == 15) {
+    guint16 picture_id = GST_READ_UINT16_BE (p) & 0x7FFF;
+
+    GST_WRITE_UINT16_BE (p, 0x8000 | ((picture_id - offset) & 0x7FFF));
+  } else {
+    p[0] = (p[0] - offset) & 0x7F;
+  }
+}
+
+static GstFlowReturn
+gst_rtp_temporal_filter_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstRtpTemporalFilter *self = GST_RTP_TEMPORAL_FILTER (parent);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  RtpLayerInfo info = { 0, };
+  gboolean have_info = FALSE;
+  guint max_layer, ext_id;
+
+  GST_OBJECT_LOCK (self);
+  max_layer = self->max_temporal_layer;
+  ext_id = self->frame_marking_ext_id;
+  GST_OBJECT_UNLOCK (self);
+
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)) {
+    GST_WARNING_OBJECT (self, "Could not map RTP buffer, forwarding");
+    return gst_pad_push (self->srcpad, buffer);
+  }
+
+  /* the frame marking extension takes precedence for the layer information,
+   * but the VP8 picture ID still needs to be rewritten */
+  if (self->is_vp8)
+    have_info = parse_vp8_descriptor (&rtp, &info);
+  if (ext_id != 0 && parse_frame_marking (&rtp, ext_id, &info))
+    have_info = TRUE;
+  gst_rtp_buffer_unmap (&rtp);
+
+  /* The decision to forward is made per frame */
+  if (have_info && info.start) {
+    if (info.keyframe) {
+      self->cur_layer = max_layer;
+    } else if (max_layer < self->cur_layer) {
+      self->cur_layer = max_layer;
+    } else if (max_layer > self->cur_layer && info.sync
+        && info.tid == self->cur_layer + 1) {
+      self->cur_layer = info.tid;
+    }
+
+    self->drop_frame = info.tid > self->cur_layer;
+    if (self->drop_frame)
+      self->picture_id_offset++;
+
+    GST_LOG_OBJECT (self, "frame of layer %u, forwarding up to layer %u: %s",
+        info.tid, self->cur_layer, self->drop_frame ? "drop" : "forward");
+  }
+
+  if (self->drop_frame) {
+    GST_OBJECT_LOCK (self);
+    self->dropped++;
+    GST_OBJECT_UNLOCK (self);
+    self->seqnum_offset++;
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+
+  /* nothing dropped so far, nothing to rewrite */
+  if (self->seqnum_offset == 0 && self->picture_id_offset == 0)
+    return gst_pad_push (self->srcpad, buffer);
+
+  buffer = gst_buffer_make_writable (buffer);
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtp)) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_ERROR;
+  }
+
+  gst_rtp_buffer_set_seq (&rtp,
+      gst_rtp_buffer_get_seq (&rtp) - self->seqnum_offset);
+  if (info.picture_id_bits != 0 && self->picture_id_offset != 0)
+    rewrite_picture_id (&rtp, &info, self->picture_id_offset);
+
+  gst_rtp_buffer_unmap (&rtp);
+
+  return gst_pad_push (self->srcpad, buffer);
+}
+
+static gboolean
+gst_rtp_temporal_filter_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpTemporalFilter *self = GST_RTP_TEMPORAL_FILTER (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+    GstStructure *s;
+
+    gst_event_parse_caps (event, &caps);
+    s = gst_caps_get_structure (caps, 0);
+    self->is_vp8 = g_strcmp0 (gst_structure_get_string (s, "encoding-name"),
+        "VP8") == 0;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_temporal_filter_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpTemporalFilter *self = GST_RTP_TEMPORAL_FILTER (element);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_rtp_temporal_filter_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+}
+
+static void
+gst_rtp_temporal_filter_init (GstRtpTemporalFilter * self)
+{
+  GstPadTemplate *pad_template;
+
+  pad_template =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self), "src");
+  self->srcpad = gst_pad_new_from_template (pad_template, "src");
+  gst_element_add_pad (GST_ELEMENT_CAST (self), self->srcpad);
+
+  pad_template =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self), "sink");
+  self->sinkpad = gst_pad_new_from_template (pad_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_temporal_filter_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_temporal_filter_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->max_temporal_layer = DEFAULT_MAX_TEMPORAL_LAYER;
+  self->frame_marking_ext_id = DEFAULT_FRAME_MARKING_EXT_ID;
+  self->dropped = 0;
+  gst_rtp_temporal_filter_reset (self);
+}
+
+static void
+gst_rtp_temporal_filter_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpTemporalFilter *self = GST_RTP_TEMPORAL_FILTER (object);
+
+  switch (prop_id) {
+    case PROP_MAX_TEMPORAL_LAYER:
+      GST_OBJECT_LOCK (self);
+      self->max_temporal_layer = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FRAME_MARKING_EXT_ID:
+      GST_OBJECT_LOCK (self);
+      self->frame_marking_ext_id = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_temporal_filter_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpTemporalFilter *self = GST_RTP_TEMPORAL_FILTER (object);
+
+  switch (prop_id) {
+    case PROP_MAX_TEMPORAL_LAYER:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->max_temporal_layer);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FRAME_MARKING_EXT_ID:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->frame_marking_ext_id);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DROPPED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->dropped);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_temporal_filter_class_init (GstRtpTemporalFilterClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *element_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template (element_class, &sink_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTP temporal layer filter", "Filter/Network/RTP",
+      "Forwards only selected temporal layers of an RTP video stream",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gobject_class->set_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_temporal_filter_set_property);
+  gobject_class->get_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_temporal_filter_get_property);
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_temporal_filter_change_state);
+
+  /**
+   * GstRtpTemporalFilter:max-temporal-layer:
+   *
+   * The highest temporal layer to forward. Can be changed while playing.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_TEMPORAL_LAYER,
+      g_param_spec_uint ("max-temporal-layer", "Max temporal layer",
+          "The highest temporal layer to forward",
+          0, MAX_TEMPORAL_LAYER, DEFAULT_MAX_TEMPORAL_LAYER,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpTemporalFilter:frame-marking-ext-id:
+   *
+   * The RTP header extension ID of the frame marking extension
+   * (urn:ietf:params:rtp-hdrext:framemarking), or 0 to not use it.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_FRAME_MARKING_EXT_ID,
+      g_param_spec_uint ("frame-marking-ext-id", "Frame marking extension ID",
+          "The RTP header extension ID of the frame marking extension "
+          "(0 = disabled)", 0, 14, DEFAULT_FRAME_MARKING_EXT_ID,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpTemporalFilter:dropped:
+   *
+   * The number of packets dropped.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DROPPED,
+      g_param_spec_uint ("dropped", "Dropped",
+          "The number of packets dropped", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_temporal_filter_debug, "rtptemporalfilter",
+      0, "RTP temporal layer filter");
+}
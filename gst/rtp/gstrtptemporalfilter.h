@@ -0,0 +1,74 @@
+/* GStreamer
+ * Copyright (C) <2021> The GStreamer project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_TEMPORAL_FILTER_H__
+#define __GST_RTP_TEMPORAL_FILTER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_TEMPORAL_FILTER \
+  (gst_rtp_temporal_filter_get_type())
+#define GST_RTP_TEMPORAL_FILTER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_TEMPORAL_FILTER,GstRtpTemporalFilter))
+#define GST_RTP_TEMPORAL_FILTER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_TEMPORAL_FILTER,GstRtpTemporalFilterClass))
+#define GST_IS_RTP_TEMPORAL_FILTER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_TEMPORAL_FILTER))
+#define GST_IS_RTP_TEMPORAL_FILTER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_TEMPORAL_FILTER))
+
+typedef struct _GstRtpTemporalFilter GstRtpTemporalFilter;
+typedef struct _GstRtpTemporalFilterClass GstRtpTemporalFilterClass;
+
+struct _GstRtpTemporalFilterClass {
+  GstElementClass parent_class;
+};
+
+struct _GstRtpTemporalFilter {
+  GstElement parent;
+
+  GstPad *srcpad;
+  GstPad *sinkpad;
+
+  /* properties */
+  guint max_temporal_layer;
+  guint frame_marking_ext_id;
+  guint dropped;
+
+  gboolean is_vp8;
+
+  /* highest layer currently forwarded, this follows max_temporal_layer at
+   * points where switching is possible */
+  guint cur_layer;
+  /* whether the packets of the current frame are dropped */
+  gboolean drop_frame;
+
+  /* number of packets and frames dropped so far, subtracted from the
+   * seqnums and picture IDs of the forwarded packets */
+  guint16 seqnum_offset;
+  guint16 picture_id_offset;
+};
+
+GType gst_rtp_temporal_filter_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_TEMPORAL_FILTER_H__ */
@@ -352,6 +352,7 @@ enum
 #define DEFAULT_MAX_STREAMS          G_MAXUINT
 #define DEFAULT_MAX_TS_OFFSET_ADJUSTMENT G_GUINT64_CONSTANT(0)
 #define DEFAULT_MAX_TS_OFFSET        G_GINT64_CONSTANT(3000000000)
+#define DEFAULT_SHARED_RTCP_SCHEDULER FALSE
 
 enum
 {
@@ -381,6 +382,7 @@ enum
   PROP_MAX_TS_OFFSET,
   PROP_FEC_DECODERS,
   PROP_FEC_ENCODERS,
+  PROP_SHARED_RTCP_SCHEDULER,
 };
 
 #define GST_RTP_BIN_RTCP_SYNC_TYPE (gst_rtp_bin_rtcp_sync_get_type())
@@ -755,7 +757,7 @@ create_session (GstRtpBin * rtpbin, gint id)
   g_object_set (demux, "max-streams", rtpbin->max_streams, NULL);
   g_object_set (session, "sdes", rtpbin->sdes, "rtp-profile",
       rtpbin->rtp_profile, "rtcp-sync-send-time", rtpbin->rtcp_sync_send_time,
-      NULL);
+      "shared-rtcp-scheduler", rtpbin->shared_rtcp_scheduler, NULL);
   if (rtpbin->use_pipeline_clock)
     g_object_set (session, "use-pipeline-clock", rtpbin->use_pipeline_clock,
         NULL);
@@ -2765,6 +2767,19 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
           "fec-encoders='fec,0=\"rtpst2022-1-fecenc\\ rows\\=5\\ columns\\=5\";'",
           GST_TYPE_STRUCTURE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpBin:shared-rtcp-scheduler:
+   *
+   * Set the #GstRtpSession:shared-rtcp-scheduler property on the sessions.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_RTCP_SCHEDULER,
+      g_param_spec_boolean ("shared-rtcp-scheduler", "Shared RTCP Scheduler",
+          "Schedule RTCP in a thread pool shared by all sessions instead of "
+          "in a thread per session", DEFAULT_SHARED_RTCP_SCHEDULER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_rtp_bin_change_state);
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_rtp_bin_request_new_pad);
@@ -2843,6 +2858,7 @@ gst_rtp_bin_init (GstRtpBin * rtpbin)
   rtpbin->rtp_profile = DEFAULT_RTP_PROFILE;
   rtpbin->ntp_time_source = DEFAULT_NTP_TIME_SOURCE;
   rtpbin->rtcp_sync_send_time = DEFAULT_RTCP_SYNC_SEND_TIME;
+  rtpbin->shared_rtcp_scheduler = DEFAULT_SHARED_RTCP_SCHEDULER;
   rtpbin->max_rtcp_rtp_time_diff = DEFAULT_MAX_RTCP_RTP_TIME_DIFF;
   rtpbin->max_dropout_time = DEFAULT_MAX_DROPOUT_TIME;
   rtpbin->max_misorder_time = DEFAULT_MAX_MISORDER_TIME;
@@ -3171,6 +3187,20 @@ gst_rtp_bin_set_property (GObject * object, guint prop_id,
     case PROP_FEC_ENCODERS:
       gst_rtp_bin_set_fec_encoders_struct (rtpbin, g_value_get_boxed (value));
       break;
+    case PROP_SHARED_RTCP_SCHEDULER:{
+      GSList *sessions;
+      GST_RTP_BIN_LOCK (rtpbin);
+      rtpbin->shared_rtcp_scheduler = g_value_get_boolean (value);
+      for (sessions = rtpbin->sessions; sessions;
+          sessions = g_slist_next (sessions)) {
+        GstRtpBinSession *session = (GstRtpBinSession *) sessions->data;
+
+        g_object_set (G_OBJECT (session->session),
+            "shared-rtcp-scheduler", rtpbin->shared_rtcp_scheduler, NULL);
+      }
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3271,6 +3301,11 @@ gst_rtp_bin_get_property (GObject * object, guint prop_id,
     case PROP_FEC_ENCODERS:
       g_value_take_boxed (value, gst_rtp_bin_get_fec_encoders_struct (rtpbin));
       break;
+    case PROP_SHARED_RTCP_SCHEDULER:
+      GST_RTP_BIN_LOCK (rtpbin);
+      g_value_set_boolean (value, rtpbin->shared_rtcp_scheduler);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
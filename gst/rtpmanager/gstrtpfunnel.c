@@ -217,45 +217,143 @@ done:
   return;
 }
 
-static void
-gst_rtp_funnel_set_twcc_seqnum (GstRtpFunnel * funnel,
-    GstPad * pad, GstBuffer ** buf)
+/* Writes the next transport-wide seqnum into the twcc extension of @output,
+ * returns FALSE if it doesn't carry one */
+static gboolean
+gst_rtp_funnel_write_twcc_seqnum (GstRtpFunnel * funnel, GstBuffer * input,
+    GstBuffer * output)
 {
-  GstRtpFunnelPad *fpad = GST_RTP_FUNNEL_PAD_CAST (pad);
   guint8 twcc_seq[2] = { 0, };
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
   guint ext_id = gst_rtp_header_extension_get_id (funnel->twcc_ext);
+  gboolean written = FALSE;
   guint8 *existing;
   guint size;
 
-  if (!funnel->twcc_ext || !fpad->has_twcc)
-    return;
+  gst_rtp_header_extension_write (funnel->twcc_ext, input,
+      GST_RTP_HEADER_EXTENSION_ONE_BYTE, output, twcc_seq, sizeof (twcc_seq));
 
-  *buf = gst_buffer_make_writable (*buf);
-
-  gst_rtp_header_extension_write (funnel->twcc_ext, *buf,
-      GST_RTP_HEADER_EXTENSION_ONE_BYTE, *buf, twcc_seq, sizeof (twcc_seq));
-
-  if (!gst_rtp_buffer_map (*buf, GST_MAP_READWRITE, &rtp))
+  if (!gst_rtp_buffer_map (output, GST_MAP_READWRITE, &rtp))
     goto map_failed;
 
   if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, ext_id,
           0, (gpointer) & existing, &size)) {
-    if (size >= gst_rtp_header_extension_get_max_size (funnel->twcc_ext, *buf)) {
+    if (size >= gst_rtp_header_extension_get_max_size (funnel->twcc_ext,
+            output)) {
       existing[0] = twcc_seq[0];
       existing[1] = twcc_seq[1];
+      written = TRUE;
     }
   }
   /* TODO: two-byte variant */
 
   gst_rtp_buffer_unmap (&rtp);
 
-  return;
+  return written;
 
 map_failed:
   {
-    GST_ERROR ("failed to map buffer %p", *buf);
+    GST_ERROR ("failed to map buffer %p", output);
+    return FALSE;
+  }
+}
+
+/* Returns the size of the RTP header including CSRCs and header extension if
+ * it is completely contained in the first memory of @buf, 0 otherwise */
+static guint
+gst_rtp_funnel_get_header_len (GstBuffer * buf)
+{
+  GstMemory *mem;
+  GstMapInfo map;
+  guint len = 0;
+
+  if (gst_buffer_n_memory (buf) == 0)
+    return 0;
+
+  mem = gst_buffer_peek_memory (buf, 0);
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    return 0;
+
+  /* version 2 only, and no padding as that lives at the end of the packet
+   * which a header-only buffer would not have */
+  if (map.size < 12 || (map.data[0] & 0xe0) != 0x80)
+    goto done;
+
+  len = 12 + (map.data[0] & 0x0f) * 4;
+  if (map.data[0] & 0x10) {
+    if (map.size < len + 4) {
+      len = 0;
+      goto done;
+    }
+    len += 4 + GST_READ_UINT16_BE (map.data + len + 2) * 4;
   }
+
+  if (len > map.size)
+    len = 0;
+
+done:
+  gst_memory_unmap (mem, &map);
+
+  return len;
+}
+
+static void
+gst_rtp_funnel_set_twcc_seqnum (GstRtpFunnel * funnel,
+    GstPad * pad, GstBuffer ** buf)
+{
+  GstRtpFunnelPad *fpad = GST_RTP_FUNNEL_PAD_CAST (pad);
+  GstBuffer *hdrbuf;
+  GstMemory *mem, *hdr;
+  guint hdr_len;
+
+  if (!funnel->twcc_ext || !fpad->has_twcc)
+    return;
+
+  /* nobody else sees this packet, stamp it in place */
+  if (gst_buffer_n_memory (*buf) == 1 && gst_buffer_is_writable (*buf) &&
+      gst_buffer_is_all_memory_writable (*buf)) {
+    gst_rtp_funnel_write_twcc_seqnum (funnel, *buf, *buf);
+    return;
+  }
+
+  hdr_len = gst_rtp_funnel_get_header_len (*buf);
+  if (hdr_len == 0) {
+    *buf = gst_buffer_make_writable (*buf);
+    gst_rtp_funnel_write_twcc_seqnum (funnel, *buf, *buf);
+    return;
+  }
+
+  /* Mapping a shared or multi-memory packet for writing would copy all of
+   * it, payload included. Instead stamp a private copy of just the header
+   * and swap that in, the payload memory stays shared. */
+  mem = gst_buffer_peek_memory (*buf, 0);
+  hdrbuf = gst_buffer_new ();
+  gst_buffer_append_memory (hdrbuf, gst_memory_copy (mem, 0, hdr_len));
+
+  if (gst_rtp_funnel_write_twcc_seqnum (funnel, *buf, hdrbuf)) {
+    hdr = gst_buffer_get_memory (hdrbuf, 0);
+
+    *buf = gst_buffer_make_writable (*buf);
+    mem = gst_buffer_get_memory (*buf, 0);
+    gst_buffer_replace_memory (*buf, 0, hdr);
+    if (gst_memory_get_sizes (mem, NULL, NULL) > hdr_len)
+      gst_buffer_insert_memory (*buf, 1, gst_memory_share (mem, hdr_len, -1));
+    gst_memory_unref (mem);
+  }
+
+  gst_buffer_unref (hdrbuf);
+}
+
+static gboolean
+gst_rtp_funnel_set_twcc_seqnum_list_func (GstBuffer ** buf, guint idx,
+    gpointer user_data)
+{
+  GstPad *pad = user_data;
+
+  gst_rtp_funnel_set_twcc_seqnum (GST_RTP_FUNNEL_CAST (GST_PAD_PARENT (pad)),
+      pad, buf);
+
+  return TRUE;
 }
 
 static GstFlowReturn
@@ -272,7 +370,14 @@ gst_rtp_funnel_sink_chain_object (GstPad * pad, GstRtpFunnel * funnel,
   gst_rtp_funnel_forward_segment (funnel, pad);
 
   if (is_list) {
-    res = gst_pad_push_list (funnel->srcpad, GST_BUFFER_LIST_CAST (obj));
+    GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+
+    if (funnel->twcc_ext && GST_RTP_FUNNEL_PAD_CAST (pad)->has_twcc) {
+      list = gst_buffer_list_make_writable (list);
+      gst_buffer_list_foreach (list,
+          gst_rtp_funnel_set_twcc_seqnum_list_func, pad);
+    }
+    res = gst_pad_push_list (funnel->srcpad, list);
   } else {
     GstBuffer *buf = GST_BUFFER_CAST (obj);
     gst_rtp_funnel_set_twcc_seqnum (funnel, pad, &buf);
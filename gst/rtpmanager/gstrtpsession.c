@@ -222,6 +222,7 @@ enum
 #define DEFAULT_RTP_PROFILE          GST_RTP_PROFILE_AVP
 #define DEFAULT_NTP_TIME_SOURCE      GST_RTP_NTP_TIME_SOURCE_NTP
 #define DEFAULT_RTCP_SYNC_SEND_TIME  TRUE
+#define DEFAULT_SHARED_RTCP_SCHEDULER FALSE
 
 enum
 {
@@ -243,7 +244,8 @@ enum
   PROP_TWCC_STATS,
   PROP_RTP_PROFILE,
   PROP_NTP_TIME_SOURCE,
-  PROP_RTCP_SYNC_SEND_TIME
+  PROP_RTCP_SYNC_SEND_TIME,
+  PROP_SHARED_RTCP_SCHEDULER
 };
 
 #define GST_RTP_SESSION_LOCK(sess)   g_mutex_lock (&(sess)->priv->lock)
@@ -267,6 +269,12 @@ struct _GstRtpSessionPrivate
   gboolean thread_stopped;
   gboolean wait_send;
 
+  /* shared RTCP scheduling instead of the thread above */
+  gboolean shared_rtcp_scheduler;
+  gboolean shared_running;
+  gboolean shared_started;
+  gint shared_task_pending;
+
   /* caps mapping */
   GHashTable *ptmap;
 
@@ -805,6 +813,33 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
           DEFAULT_RTCP_SYNC_SEND_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpSession:shared-rtcp-scheduler:
+   *
+   * Instead of starting a thread per session that waits for the next RTCP
+   * deadline, wait for it asynchronously on the system clock, and handle
+   * the timeouts of all sessions that enable this in a shared thread pool.
+   * This reduces the number of threads and wakeups when running many
+   * sessions in one process. The RTCP timing rules are the same in both
+   * modes.
+   *
+   * RTCP is pushed downstream from the pool threads. A session whose RTCP
+   * source pad blocks keeps one of them busy until the push returns, the
+   * pool then starts another thread for the other sessions. With many
+   * sessions blocking at the same time, as many threads are used as with
+   * the per-session threads.
+   *
+   * Changing this property takes effect the next time the element goes to
+   * PLAYING.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_RTCP_SCHEDULER,
+      g_param_spec_boolean ("shared-rtcp-scheduler", "Shared RTCP Scheduler",
+          "Schedule RTCP in a thread pool shared by all sessions instead of "
+          "in a thread per session", DEFAULT_SHARED_RTCP_SCHEDULER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_rtp_session_change_state);
   gstelement_class->request_new_pad =
@@ -860,6 +895,7 @@ gst_rtp_session_init (GstRtpSession * rtpsession)
   rtpsession->priv->session = rtp_session_new ();
   rtpsession->priv->use_pipeline_clock = DEFAULT_USE_PIPELINE_CLOCK;
   rtpsession->priv->rtcp_sync_send_time = DEFAULT_RTCP_SYNC_SEND_TIME;
+  rtpsession->priv->shared_rtcp_scheduler = DEFAULT_SHARED_RTCP_SCHEDULER;
 
   /* configure callbacks */
   rtp_session_set_callbacks (rtpsession->priv->session, &callbacks, rtpsession);
@@ -977,6 +1013,11 @@ gst_rtp_session_set_property (GObject * object, guint prop_id,
     case PROP_RTCP_SYNC_SEND_TIME:
       priv->rtcp_sync_send_time = g_value_get_boolean (value);
       break;
+    case PROP_SHARED_RTCP_SCHEDULER:
+      GST_RTP_SESSION_LOCK (rtpsession);
+      priv->shared_rtcp_scheduler = g_value_get_boolean (value);
+      GST_RTP_SESSION_UNLOCK (rtpsession);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1056,6 +1097,11 @@ gst_rtp_session_get_property (GObject * object, guint prop_id,
     case PROP_RTCP_SYNC_SEND_TIME:
       g_value_set_boolean (value, priv->rtcp_sync_send_time);
       break;
+    case PROP_SHARED_RTCP_SCHEDULER:
+      GST_RTP_SESSION_LOCK (rtpsession);
+      g_value_set_boolean (value, priv->shared_rtcp_scheduler);
+      GST_RTP_SESSION_UNLOCK (rtpsession);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1135,6 +1181,8 @@ get_current_times (GstRtpSession * rtpsession, GstClockTime * running_time,
     *ntpnstime = ntpns;
 }
 
+static void push_shared_rtcp_task_unlocked (GstRtpSession * rtpsession);
+
 /* must be called with GST_RTP_SESSION_LOCK */
 static void
 signal_waiting_rtcp_thread_unlocked (GstRtpSession * rtpsession)
@@ -1142,7 +1190,10 @@ signal_waiting_rtcp_thread_unlocked (GstRtpSession * rtpsession)
   if (rtpsession->priv->wait_send) {
     GST_LOG_OBJECT (rtpsession, "signal RTCP thread");
     rtpsession->priv->wait_send = FALSE;
-    GST_RTP_SESSION_SIGNAL (rtpsession);
+    if (rtpsession->priv->shared_running && !rtpsession->priv->stop_thread)
+      push_shared_rtcp_task_unlocked (rtpsession);
+    else
+      GST_RTP_SESSION_SIGNAL (rtpsession);
   }
 }
 
@@ -1225,6 +1276,142 @@ rtcp_thread (GstRtpSession * rtpsession)
   GST_DEBUG_OBJECT (rtpsession, "leaving RTCP thread");
 }
 
+/* Shared RTCP scheduling: instead of a thread per session, the next RTCP
+ * deadline of each session is waited for asynchronously on the system clock,
+ * which handles the entries of all sessions in one thread ordered by their
+ * deadline. When it expires, the timeout is handled by a thread from a pool
+ * shared by all sessions, because it might push downstream and block. The
+ * pool has no thread limit so that a session blocked in a push can't delay
+ * the RTCP of the others, threads are only added while all are busy. The
+ * task does what one iteration of rtcp_thread() does. */
+static GThreadPool *rtcp_pool = NULL;
+G_LOCK_DEFINE_STATIC (rtcp_pool);
+
+/* can be called without GST_RTP_SESSION_LOCK */
+static void
+push_shared_rtcp_task_unlocked (GstRtpSession * rtpsession)
+{
+  /* a queued or running task schedules the next timeout when done */
+  if (!g_atomic_int_compare_and_exchange (&rtpsession->priv->
+          shared_task_pending, FALSE, TRUE))
+    return;
+
+  g_thread_pool_push (rtcp_pool, gst_object_ref (rtpsession), NULL);
+}
+
+/* called from the clock thread that serves all sessions, so this must not
+ * take GST_RTP_SESSION_LOCK, which can be held while pushing */
+static gboolean
+rtcp_shared_timeout_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstRtpSession *rtpsession = GST_RTP_SESSION_CAST (user_data);
+
+  /* ignore timeouts that were replaced or unscheduled in the meantime, the
+   * entry is cleared when stopping. A task that runs for a stale timeout
+   * only checks for timeouts early */
+  if (g_atomic_pointer_get (&rtpsession->priv->id) == id)
+    push_shared_rtcp_task_unlocked (rtpsession);
+
+  return TRUE;
+}
+
+static void
+rtcp_shared_task (GstRtpSession * rtpsession, gpointer user_data)
+{
+  GstClockID id;
+  GstClockTime current_time;
+  GstClockTime next_timeout;
+  guint64 ntpnstime;
+  GstClockTime running_time;
+  RTPSession *session;
+  GstClock *sysclock;
+
+  GST_RTP_SESSION_LOCK (rtpsession);
+  if (rtpsession->priv->stop_thread)
+    goto stopped;
+
+  sysclock = rtpsession->priv->sysclock;
+  session = rtpsession->priv->session;
+  current_time = gst_clock_get_time (sysclock);
+
+  if (!rtpsession->priv->shared_started) {
+    GST_DEBUG_OBJECT (rtpsession, "starting at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (current_time));
+    session->start_time = current_time;
+    rtpsession->priv->shared_started = TRUE;
+  } else {
+    get_current_times (rtpsession, &running_time, &ntpnstime);
+
+    GST_DEBUG_OBJECT (rtpsession, "timeout, current %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (current_time));
+
+    GST_RTP_SESSION_UNLOCK (rtpsession);
+    rtp_session_on_timeout (session, current_time, ntpnstime, running_time);
+    GST_RTP_SESSION_LOCK (rtpsession);
+
+    if (rtpsession->priv->stop_thread)
+      goto stopped;
+  }
+
+  next_timeout = rtp_session_next_timeout (session, current_time);
+
+  GST_DEBUG_OBJECT (rtpsession, "next check time %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (next_timeout));
+
+  if (rtpsession->priv->id) {
+    gst_clock_id_unschedule (rtpsession->priv->id);
+    gst_clock_id_unref (rtpsession->priv->id);
+    g_atomic_pointer_set (&rtpsession->priv->id, NULL);
+  }
+
+  /* no more timeouts, the session ended */
+  if (next_timeout == GST_CLOCK_TIME_NONE)
+    goto stopped;
+
+  id = gst_clock_new_single_shot_id (sysclock, next_timeout);
+  g_atomic_pointer_set (&rtpsession->priv->id, id);
+  gst_clock_id_wait_async (id, rtcp_shared_timeout_cb,
+      gst_object_ref (rtpsession), (GDestroyNotify) gst_object_unref);
+
+  g_atomic_int_set (&rtpsession->priv->shared_task_pending, FALSE);
+  GST_RTP_SESSION_UNLOCK (rtpsession);
+  gst_object_unref (rtpsession);
+  return;
+
+stopped:
+  {
+    GST_DEBUG_OBJECT (rtpsession, "shared RTCP scheduling stopped");
+    g_atomic_int_set (&rtpsession->priv->shared_task_pending, FALSE);
+    rtpsession->priv->thread_stopped = TRUE;
+    GST_RTP_SESSION_SIGNAL (rtpsession);
+    GST_RTP_SESSION_UNLOCK (rtpsession);
+    gst_object_unref (rtpsession);
+  }
+}
+
+static gboolean
+start_shared_rtcp (GstRtpSession * rtpsession, GError ** error)
+{
+  G_LOCK (rtcp_pool);
+  if (rtcp_pool == NULL)
+    rtcp_pool = g_thread_pool_new ((GFunc) rtcp_shared_task, NULL, -1, FALSE,
+        error);
+  G_UNLOCK (rtcp_pool);
+
+  if (rtcp_pool == NULL)
+    return FALSE;
+
+  GST_RTP_SESSION_LOCK (rtpsession);
+  rtpsession->priv->shared_started = FALSE;
+  /* wait for getting started like the RTCP thread does */
+  if (!rtpsession->priv->wait_send)
+    push_shared_rtcp_task_unlocked (rtpsession);
+  GST_RTP_SESSION_UNLOCK (rtpsession);
+
+  return TRUE;
+}
+
 static gboolean
 start_rtcp_thread (GstRtpSession * rtpsession)
 {
@@ -1239,16 +1426,33 @@ start_rtcp_thread (GstRtpSession * rtpsession)
     /* if the thread stopped, and we still have a handle to the thread, join it
      * now. We can safely join with the lock held, the thread will not take it
      * anymore. */
-    if (rtpsession->priv->thread)
+    if (rtpsession->priv->thread) {
       g_thread_join (rtpsession->priv->thread);
+      rtpsession->priv->thread = NULL;
+    }
+    rtpsession->priv->thread_stopped = FALSE;
+    rtpsession->priv->shared_running =
+        rtpsession->priv->shared_rtcp_scheduler;
+
+    if (rtpsession->priv->shared_running) {
+      GST_RTP_SESSION_UNLOCK (rtpsession);
+      if (!start_shared_rtcp (rtpsession, &error)) {
+        GST_RTP_SESSION_LOCK (rtpsession);
+        rtpsession->priv->thread_stopped = TRUE;
+        GST_RTP_SESSION_UNLOCK (rtpsession);
+      }
+      goto done;
+    }
+
     /* only create a new thread if the old one was stopped. Otherwise we can
      * just reuse the currently running one. */
     rtpsession->priv->thread = g_thread_try_new ("rtpsession-rtcp",
         (GThreadFunc) rtcp_thread, rtpsession, &error);
-    rtpsession->priv->thread_stopped = FALSE;
   }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 
+done:
+
   if (error != NULL) {
     res = FALSE;
     GST_DEBUG_OBJECT (rtpsession, "failed to start thread, %s", error->message);
@@ -1269,6 +1473,17 @@ stop_rtcp_thread (GstRtpSession * rtpsession)
   signal_waiting_rtcp_thread_unlocked (rtpsession);
   if (rtpsession->priv->id)
     gst_clock_id_unschedule (rtpsession->priv->id);
+
+  if (rtpsession->priv->shared_running) {
+    /* the clock entry is ours, the RTCP thread would release it otherwise */
+    if (rtpsession->priv->id) {
+      gst_clock_id_unref (rtpsession->priv->id);
+      g_atomic_pointer_set (&rtpsession->priv->id, NULL);
+    }
+    /* a pending task marks us as stopped when it runs */
+    if (!g_atomic_int_get (&rtpsession->priv->shared_task_pending))
+      rtpsession->priv->thread_stopped = TRUE;
+  }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 }
 
@@ -1287,6 +1502,11 @@ join_rtcp_thread (GstRtpSession * rtpsession)
     /* after the join, take the lock and clear the thread structure. The caller
      * is supposed to not concurrently call start and join. */
     rtpsession->priv->thread = NULL;
+  } else if (rtpsession->priv->shared_running) {
+    GST_DEBUG_OBJECT (rtpsession, "waiting for shared RTCP task");
+    while (!rtpsession->priv->thread_stopped)
+      GST_RTP_SESSION_WAIT (rtpsession);
+    rtpsession->priv->shared_running = FALSE;
   }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 }
@@ -1719,8 +1939,16 @@ gst_rtp_session_reconsider (RTPSession * sess, gpointer user_data)
 
   GST_RTP_SESSION_LOCK (rtpsession);
   GST_DEBUG_OBJECT (rtpsession, "unlock timer for reconsideration");
-  if (rtpsession->priv->id)
+  if (rtpsession->priv->shared_running) {
+    /* unscheduled async entries are not called back, handle the timeout
+     * right away instead */
+    if (rtpsession->priv->id && !rtpsession->priv->stop_thread) {
+      gst_clock_id_unschedule (rtpsession->priv->id);
+      push_shared_rtcp_task_unlocked (rtpsession);
+    }
+  } else if (rtpsession->priv->id) {
     gst_clock_id_unschedule (rtpsession->priv->id);
+  }
   GST_RTP_SESSION_UNLOCK (rtpsession);
 }
 
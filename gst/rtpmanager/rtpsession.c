@@ -2060,6 +2060,76 @@ rtp_session_create_new_ssrc (RTPSession * sess)
   return ssrc;
 }
 
+/* Find the transport-wide seqnum in the one-byte or two-byte header
+ * extension of the packet while it is mapped, the packet data is not
+ * available anymore when the seqnum is needed later. */
+static void
+packet_info_parse_twcc_seqnum (RTPPacketInfo * pinfo, GstRTPBuffer * rtp)
+{
+  guint16 bits;
+  guint8 *data;
+  guint wordlen;
+  gsize size, offset = 0;
+
+  if (!gst_rtp_buffer_get_extension_data (rtp, &bits, (gpointer *) & data,
+          &wordlen))
+    return;
+
+  size = wordlen * 4;
+
+  if (bits == 0xBEDE) {
+    while (offset < size) {
+      guint8 id = data[offset] >> 4;
+      guint len = (data[offset] & 0x0F) + 1;
+
+      /* padding */
+      if (data[offset] == 0) {
+        offset++;
+        continue;
+      }
+      /* reserved for future extensions, stop parsing */
+      if (id == 15)
+        return;
+
+      offset++;
+      if (offset + len > size)
+        return;
+
+      if (id == pinfo->tw_seqnum_ext_id) {
+        if (len == 2)
+          pinfo->tw_seqnum = GST_READ_UINT16_BE (&data[offset]);
+        return;
+      }
+      offset += len;
+    }
+  } else if ((bits >> 4) == 0x100) {
+    while (offset < size) {
+      guint8 id = data[offset];
+      guint len;
+
+      /* padding */
+      if (id == 0) {
+        offset++;
+        continue;
+      }
+
+      if (offset + 2 > size)
+        return;
+      len = data[offset + 1];
+      offset += 2;
+      if (offset + len > size)
+        return;
+
+      if (id == pinfo->tw_seqnum_ext_id) {
+        if (len == 2)
+          pinfo->tw_seqnum = GST_READ_UINT16_BE (&data[offset]);
+        return;
+      }
+      offset += len;
+    }
+  }
+}
+
 static gboolean
 update_packet (GstBuffer ** buffer, guint idx, RTPPacketInfo * pinfo)
 {
@@ -2090,9 +2160,9 @@ update_packet (GstBuffer ** buffer, guint idx, RTPPacketInfo * pinfo)
       for (i = 0; i < pinfo->csrc_count; i++)
         pinfo->csrcs[i] = gst_rtp_buffer_get_csrc (&rtp, i);
 
-      /* RTP header extensions */
-      pinfo->header_ext = gst_rtp_buffer_get_extension_bytes (&rtp,
-          &pinfo->header_ext_bit_pattern);
+      /* transport-wide seqnum from the RTP header extension */
+      if (pinfo->tw_seqnum_ext_id != 0)
+        packet_info_parse_twcc_seqnum (pinfo, &rtp);
     }
     gst_rtp_buffer_unmap (&rtp);
   }
@@ -2141,7 +2211,20 @@ update_packet_info (RTPSession * sess, RTPPacketInfo * pinfo,
   pinfo->bytes = 0;
   pinfo->payload_len = 0;
   pinfo->packets = 0;
+  pinfo->address = NULL;
+  pinfo->ssrc = 0;
+  pinfo->seqnum = 0;
+  pinfo->pt = 0;
+  pinfo->rtptime = 0;
   pinfo->marker = FALSE;
+  pinfo->csrc_count = 0;
+  /* only parse the transport-wide seqnum when it was negotiated */
+  if (rtp)
+    pinfo->tw_seqnum_ext_id =
+        send ? sess->twcc_send_ext_id : sess->twcc_recv_ext_id;
+  else
+    pinfo->tw_seqnum_ext_id = 0;
+  pinfo->tw_seqnum = -1;
 
   if (is_list) {
     GstBufferList *list = GST_BUFFER_LIST_CAST (data);
@@ -2165,24 +2248,6 @@ clean_packet_info (RTPPacketInfo * pinfo)
     gst_mini_object_unref (pinfo->data);
     pinfo->data = NULL;
   }
-  if (pinfo->header_ext)
-    g_bytes_unref (pinfo->header_ext);
-}
-
-static gint32
-packet_info_get_twcc_seqnum (RTPPacketInfo * pinfo, guint8 ext_id)
-{
-  gint32 val = -1;
-  gpointer data;
-  guint size;
-
-  if (pinfo->header_ext &&
-      gst_rtp_buffer_get_extension_onebyte_header_from_bytes (pinfo->header_ext,
-          pinfo->header_ext_bit_pattern, ext_id, 0, &data, &size)) {
-    if (size == 2)
-      val = GST_READ_UINT16_BE (data);
-  }
-  return val;
 }
 
 static gboolean
@@ -2212,10 +2277,7 @@ process_twcc_packet (RTPSession * sess, RTPPacketInfo * pinfo)
 {
   gint32 twcc_seqnum;
 
-  if (sess->twcc_recv_ext_id == 0)
-    return;
-
-  twcc_seqnum = packet_info_get_twcc_seqnum (pinfo, sess->twcc_recv_ext_id);
+  twcc_seqnum = pinfo->tw_seqnum;
   if (twcc_seqnum == -1)
     return;
 
@@ -2278,7 +2340,7 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   RTPSource *source;
   gboolean created;
   gboolean prevsender, prevactive;
-  RTPPacketInfo pinfo = { 0, };
+  RTPPacketInfo pinfo;
   guint64 oldrate;
 
   g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
@@ -3023,7 +3085,7 @@ rtp_session_process_rtcp (RTPSession * sess, GstBuffer * buffer,
 {
   GstRTCPPacket packet;
   gboolean more, is_bye = FALSE, do_sync = FALSE;
-  RTPPacketInfo pinfo = { 0, };
+  RTPPacketInfo pinfo;
   GstFlowReturn result = GST_FLOW_OK;
   GstRTCPBuffer rtcp = { NULL, };
 
@@ -3214,10 +3276,7 @@ send_twcc_packet (RTPSession * sess, RTPPacketInfo * pinfo)
 {
   gint32 twcc_seqnum;
 
-  if (sess->twcc_send_ext_id == 0)
-    return;
-
-  twcc_seqnum = packet_info_get_twcc_seqnum (pinfo, sess->twcc_send_ext_id);
+  twcc_seqnum = pinfo->tw_seqnum;
   if (twcc_seqnum == -1)
     return;
 
@@ -3246,7 +3305,7 @@ rtp_session_send_rtp (RTPSession * sess, gpointer data, gboolean is_list,
   RTPSource *source;
   gboolean prevsender;
   guint64 oldrate;
-  RTPPacketInfo pinfo = { 0, };
+  RTPPacketInfo pinfo;
   gboolean created;
 
   g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
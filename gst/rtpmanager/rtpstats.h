@@ -104,8 +104,8 @@ typedef struct {
   gboolean      marker;
   guint32       csrc_count;
   guint32       csrcs[16];
-  GBytes        *header_ext;
-  guint16       header_ext_bit_pattern;
+  guint8        tw_seqnum_ext_id;
+  gint32        tw_seqnum;
 } RTPPacketInfo;
 
 /**
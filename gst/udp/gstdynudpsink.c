@@ -68,6 +68,8 @@ static void gst_dynudpsink_finalize (GObject * object);
 
 static GstFlowReturn gst_dynudpsink_render (GstBaseSink * sink,
     GstBuffer * buffer);
+static GstFlowReturn gst_dynudpsink_render_list (GstBaseSink * sink,
+    GstBufferList * buffer_list);
 static gboolean gst_dynudpsink_stop (GstBaseSink * bsink);
 static gboolean gst_dynudpsink_start (GstBaseSink * bsink);
 static gboolean gst_dynudpsink_unlock (GstBaseSink * bsink);
@@ -141,6 +143,7 @@ gst_dynudpsink_class_init (GstDynUDPSinkClass * klass)
       "Philippe Khalaf <burger@speedy.org>");
 
   gstbasesink_class->render = gst_dynudpsink_render;
+  gstbasesink_class->render_list = gst_dynudpsink_render_list;
   gstbasesink_class->start = gst_dynudpsink_start;
   gstbasesink_class->stop = gst_dynudpsink_stop;
   gstbasesink_class->unlock = gst_dynudpsink_unlock;
@@ -163,6 +166,13 @@ gst_dynudpsink_init (GstDynUDPSink * sink)
 
   sink->used_socket = NULL;
   sink->used_socket_v6 = NULL;
+
+  sink->vecs = NULL;
+  sink->n_vecs = 0;
+  sink->maps = NULL;
+  sink->n_maps = 0;
+  sink->messages = NULL;
+  sink->n_messages = 0;
 }
 
 static void
@@ -191,6 +201,13 @@ gst_dynudpsink_finalize (GObject * object)
   g_free (sink->bind_address);
   sink->bind_address = NULL;
 
+  g_free (sink->vecs);
+  sink->vecs = NULL;
+  g_free (sink->maps);
+  sink->maps = NULL;
+  g_free (sink->messages);
+  sink->messages = NULL;
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -280,6 +297,149 @@ invalid_family:
   }
 }
 
+static GstFlowReturn
+gst_dynudpsink_send_messages (GstDynUDPSink * sink, GSocket * socket,
+    GOutputMessage * messages, guint num_messages)
+{
+  while (num_messages > 0) {
+    GError *err = NULL;
+    gint ret;
+
+    ret = g_socket_send_messages (socket, messages, num_messages, 0,
+        sink->cancellable, &err);
+
+    if (G_UNLIKELY (ret < 0)) {
+      GstFlowReturn flow_ret;
+
+      if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        GST_DEBUG_OBJECT (sink, "send cancelled");
+        flow_ret = GST_FLOW_FLUSHING;
+      } else {
+        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
+            ("send error: %s", err->message));
+        flow_ret = GST_FLOW_ERROR;
+      }
+      g_clear_error (&err);
+      return flow_ret;
+    }
+
+    GST_LOG_OBJECT (sink, "sent %d of %u messages", ret, num_messages);
+
+    messages += ret;
+    num_messages -= ret;
+  }
+
+  return GST_FLOW_OK;
+}
+
+/* Sends the buffers of the list with as few system calls as possible: runs
+ * of packets that go out on the same socket are handed to the kernel in one
+ * go, each with its own destination address and without merging the
+ * memories of a buffer. */
+static GstFlowReturn
+gst_dynudpsink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
+{
+  GstDynUDPSink *sink = GST_DYNUDPSINK (bsink);
+  GstFlowReturn flow_ret = GST_FLOW_OK;
+  GSocket *batch_socket = NULL;
+  guint num_buffers, total_mems, num_msgs, batch_start, mem;
+  guint i, j;
+
+  num_buffers = gst_buffer_list_length (buffer_list);
+  if (num_buffers == 0)
+    return GST_FLOW_OK;
+
+  for (i = 0, total_mems = 0; i < num_buffers; ++i)
+    total_mems += gst_buffer_n_memory (gst_buffer_list_get (buffer_list, i));
+
+  /* ensure our pre-allocated scratch space arrays are large enough */
+  if (sink->n_vecs < total_mems) {
+    sink->n_vecs = GST_ROUND_UP_16 (total_mems);
+    g_free (sink->vecs);
+    sink->vecs = g_new (GOutputVector, sink->n_vecs);
+  }
+  if (sink->n_maps < total_mems) {
+    sink->n_maps = GST_ROUND_UP_16 (total_mems);
+    g_free (sink->maps);
+    sink->maps = g_new (GstMapInfo, sink->n_maps);
+  }
+  if (sink->n_messages < num_buffers) {
+    sink->n_messages = GST_ROUND_UP_16 (num_buffers);
+    g_free (sink->messages);
+    sink->messages = g_new (GOutputMessage, sink->n_messages);
+  }
+
+  num_msgs = batch_start = mem = 0;
+  for (i = 0; i < num_buffers; ++i) {
+    GstBuffer *buffer = gst_buffer_list_get (buffer_list, i);
+    GOutputMessage *msg;
+    GstNetAddressMeta *meta;
+    GSocketFamily family;
+    GSocket *socket;
+    guint n_mem;
+
+    meta = gst_buffer_get_net_address_meta (buffer);
+    if (meta == NULL) {
+      GST_DEBUG ("Received buffer without GstNetAddressMeta, skipping");
+      continue;
+    }
+
+    family = g_socket_address_get_family (meta->addr);
+    if (family == G_SOCKET_FAMILY_IPV6 && !sink->used_socket_v6) {
+      GST_DEBUG ("invalid address family (got %d)", family);
+      flow_ret = GST_FLOW_ERROR;
+      goto out;
+    }
+
+    /* Select socket to send from for this address */
+    if (family == G_SOCKET_FAMILY_IPV6 || !sink->used_socket)
+      socket = sink->used_socket_v6;
+    else
+      socket = sink->used_socket;
+
+    /* send what we have so far if this packet goes out on the other socket */
+    if (socket != batch_socket && num_msgs > batch_start) {
+      flow_ret = gst_dynudpsink_send_messages (sink, batch_socket,
+          &sink->messages[batch_start], num_msgs - batch_start);
+      if (flow_ret != GST_FLOW_OK)
+        goto out;
+      batch_start = num_msgs;
+    }
+    batch_socket = socket;
+
+    n_mem = gst_buffer_n_memory (buffer);
+    msg = &sink->messages[num_msgs++];
+    msg->address = meta->addr;
+    msg->vectors = &sink->vecs[mem];
+    msg->num_vectors = n_mem;
+    msg->bytes_sent = 0;
+    msg->control_messages = NULL;
+    msg->num_control_messages = 0;
+
+    for (j = 0; j < n_mem; ++j, ++mem) {
+      GstMemory *memory = gst_buffer_peek_memory (buffer, j);
+
+      if (!gst_memory_map (memory, &sink->maps[mem], GST_MAP_READ)) {
+        GST_ERROR_OBJECT (sink, "failed to map memory %p", memory);
+        flow_ret = GST_FLOW_ERROR;
+        goto out;
+      }
+      sink->vecs[mem].buffer = sink->maps[mem].data;
+      sink->vecs[mem].size = sink->maps[mem].size;
+    }
+  }
+
+  if (num_msgs > batch_start)
+    flow_ret = gst_dynudpsink_send_messages (sink, batch_socket,
+        &sink->messages[batch_start], num_msgs - batch_start);
+
+out:
+  for (i = 0; i < mem; ++i)
+    gst_memory_unmap (sink->maps[i].memory, &sink->maps[i]);
+
+  return flow_ret;
+}
+
 static void
 gst_dynudpsink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
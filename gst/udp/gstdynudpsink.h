@@ -54,6 +54,14 @@ struct _GstDynUDPSink {
   gboolean external_socket;
   gboolean made_cancel_fd;
   GCancellable *cancellable;
+
+  /* pre-allocated scrap space for the render_list function */
+  GOutputVector *vecs;
+  guint n_vecs;
+  GstMapInfo *maps;
+  guint n_maps;
+  GOutputMessage *messages;
+  guint n_messages;
 };
 
 struct _GstDynUDPSinkClass {
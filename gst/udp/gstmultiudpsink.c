@@ -52,6 +52,10 @@ GST_DEBUG_CATEGORY_STATIC (multiudpsink_debug);
 
 #define UDP_MAX_SIZE 65507
 
+/* maximum number of messages handed to the socket at once when sending the
+ * same buffers to many clients */
+#define MAX_MESSAGES_PER_SHARD 1024
+
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -404,6 +408,7 @@ gst_multiudpsink_init (GstMultiUDPSink * sink)
   sink->num_v4_all = 0;
   sink->num_v6_unique = 0;
   sink->num_v6_all = 0;
+  sink->clients_snapshot = NULL;
 
   sink->socket = DEFAULT_SOCKET;
   sink->socket_v6 = DEFAULT_SOCKET;
@@ -511,6 +516,64 @@ gst_udp_client_ref (GstUDPClient * client)
   return client;
 }
 
+/* call with client lock held */
+static GstUDPClientSnapshot *
+gst_udp_client_snapshot_new (GstMultiUDPSink * sink, gboolean send_duplicates)
+{
+  GstUDPClientSnapshot *snapshot;
+  GList *l;
+  guint i, j;
+
+  snapshot = g_slice_new (GstUDPClientSnapshot);
+  snapshot->ref_count = 1;
+  snapshot->send_duplicates = send_duplicates;
+  if (send_duplicates) {
+    snapshot->num_v4 = sink->num_v4_all;
+    snapshot->num_v6 = sink->num_v6_all;
+  } else {
+    snapshot->num_v4 = sink->num_v4_unique;
+    snapshot->num_v6 = sink->num_v6_unique;
+  }
+  snapshot->clients =
+      g_new (GstUDPClient *, snapshot->num_v4 + snapshot->num_v6);
+
+  for (l = sink->clients, i = 0; l != NULL; l = l->next) {
+    GstUDPClient *client = l->data;
+
+    snapshot->clients[i++] = gst_udp_client_ref (client);
+    for (j = 1; send_duplicates && j < client->add_count; ++j)
+      snapshot->clients[i++] = gst_udp_client_ref (client);
+  }
+  g_assert_cmpuint (i, ==, snapshot->num_v4 + snapshot->num_v6);
+
+  return snapshot;
+}
+
+/* call with client lock held */
+static void
+gst_udp_client_snapshot_unref (GstUDPClientSnapshot * snapshot)
+{
+  guint i;
+
+  if (--snapshot->ref_count > 0)
+    return;
+
+  for (i = 0; i < snapshot->num_v4 + snapshot->num_v6; ++i)
+    gst_udp_client_unref (snapshot->clients[i]);
+  g_free (snapshot->clients);
+  g_slice_free (GstUDPClientSnapshot, snapshot);
+}
+
+/* call with client lock held, whenever the client list changes */
+static void
+gst_multiudpsink_invalidate_snapshot (GstMultiUDPSink * sink)
+{
+  if (sink->clients_snapshot) {
+    gst_udp_client_snapshot_unref (sink->clients_snapshot);
+    sink->clients_snapshot = NULL;
+  }
+}
+
 static gint
 client_compare (GstUDPClient * a, GstUDPClient * b)
 {
@@ -527,6 +590,7 @@ gst_multiudpsink_finalize (GObject * object)
 
   sink = GST_MULTIUDPSINK (object);
 
+  gst_multiudpsink_invalidate_snapshot (sink);
   g_list_foreach (sink->clients, (GFunc) gst_udp_client_unref, NULL);
   g_list_free (sink->clients);
 
@@ -714,50 +778,78 @@ gst_multiudpsink_send_messages (GstMultiUDPSink * sink, GSocket * socket,
   return GST_FLOW_OK;
 }
 
+/* sends the template messages to the clients [first, last) of @snapshot,
+ * using the socket matching each client's address family */
+static GstFlowReturn
+gst_multiudpsink_send_shard (GstMultiUDPSink * sink,
+    GstUDPClientSnapshot * snapshot, guint first, guint last,
+    GstOutputMessage * templ, guint num_buffers, GstOutputMessage * msgs)
+{
+  GstFlowReturn flow_ret = GST_FLOW_OK;
+  guint i, j, num_msgs_v4;
+
+  for (i = first; i < last; ++i) {
+    GstOutputMessage *client_msgs = &msgs[(i - first) * num_buffers];
+
+    for (j = 0; j < num_buffers; ++j) {
+      client_msgs[j] = templ[j];
+      client_msgs[j].address = snapshot->clients[i]->addr;
+    }
+  }
+
+  /* no IPv4 socket? Send it all from the IPv6 socket then.. */
+  if (sink->used_socket == NULL)
+    return gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
+        msgs, (last - first) * num_buffers);
+
+  /* our client list is sorted with IPv4 clients first and IPv6 ones last */
+  num_msgs_v4 = (CLAMP (snapshot->num_v4, first, last) - first) * num_buffers;
+
+  if (num_msgs_v4 > 0)
+    flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket,
+        msgs, num_msgs_v4);
+
+  if (flow_ret == GST_FLOW_OK && num_msgs_v4 < (last - first) * num_buffers)
+    flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
+        msgs + num_msgs_v4, (last - first) * num_buffers - num_msgs_v4);
+
+  return flow_ret;
+}
+
 static GstFlowReturn
 gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
     guint num_buffers, guint8 * mem_nums, guint total_mem_num)
 {
-  GstOutputMessage *msgs;
+  GstUDPClientSnapshot *snapshot;
+  GstOutputMessage *templ, *msgs;
   gboolean send_duplicates;
-  GstUDPClient **clients;
   GOutputVector *vecs;
   GstMapInfo *map_infos;
-  GstFlowReturn flow_ret;
-  guint num_addr_v4, num_addr_v6;
-  guint num_addr, num_msgs;
+  GstFlowReturn flow_ret = GST_FLOW_OK;
+  guint num_addr, clients_per_shard, first, last;
   guint i, j, mem;
   gsize size = 0;
-  GList *l;
 
   send_duplicates = sink->send_duplicates;
 
+  /* only take a reference to the current set of clients, so that the lock
+   * is not held while sending and changes to the clients don't have to wait
+   * for that */
   g_mutex_lock (&sink->client_lock);
-
-  if (send_duplicates) {
-    num_addr_v4 = sink->num_v4_all;
-    num_addr_v6 = sink->num_v6_all;
-  } else {
-    num_addr_v4 = sink->num_v4_unique;
-    num_addr_v6 = sink->num_v6_unique;
+  if (sink->clients_snapshot == NULL ||
+      sink->clients_snapshot->send_duplicates != send_duplicates) {
+    gst_multiudpsink_invalidate_snapshot (sink);
+    sink->clients_snapshot =
+        gst_udp_client_snapshot_new (sink, send_duplicates);
   }
-  num_addr = num_addr_v4 + num_addr_v6;
+  snapshot = sink->clients_snapshot;
+  snapshot->ref_count++;
+  g_mutex_unlock (&sink->client_lock);
 
+  num_addr = snapshot->num_v4 + snapshot->num_v6;
   if (num_addr == 0)
     goto no_clients;
 
-  clients = g_newa (GstUDPClient *, num_addr);
-  for (l = sink->clients, i = 0; l != NULL; l = l->next) {
-    GstUDPClient *client = l->data;
-
-    clients[i++] = gst_udp_client_ref (client);
-    for (j = 1; send_duplicates && j < client->add_count; ++j)
-      clients[i++] = gst_udp_client_ref (client);
-  }
-  g_assert_cmpuint (i, ==, num_addr);
-
-  g_mutex_unlock (&sink->client_lock);
-
   GST_LOG_OBJECT (sink, "%u buffers, %u memories -> to be sent to %u clients",
       num_buffers, total_mem_num, num_addr);
 
@@ -776,91 +868,76 @@ gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
   }
   map_infos = sink->maps;
 
-  num_msgs = num_addr * num_buffers;
-  if (sink->n_messages < num_msgs) {
-    sink->n_messages = GST_ROUND_UP_16 (num_msgs);
+  /* messages are built and sent for a limited number of clients at a time,
+   * so that the scratch space doesn't grow with the number of clients */
+  clients_per_shard = MAX (1, MAX_MESSAGES_PER_SHARD / num_buffers);
+  clients_per_shard = MIN (clients_per_shard, num_addr);
+
+  if (sink->n_messages < num_buffers * (clients_per_shard + 1)) {
+    sink->n_messages = GST_ROUND_UP_16 (num_buffers * (clients_per_shard + 1));
     g_free (sink->messages);
     sink->messages = g_new (GstOutputMessage, sink->n_messages);
   }
-  msgs = sink->messages;
+  templ = sink->messages;
+  msgs = sink->messages + num_buffers;
 
-  /* populate first num_buffers messages with output vectors for the buffers */
+  /* populate the template messages with output vectors for the buffers */
   for (i = 0, mem = 0; i < num_buffers; ++i) {
     size += fill_vectors (&vecs[mem], &map_infos[mem], mem_nums[i], buffers[i]);
-    msgs[i].vectors = &vecs[mem];
-    msgs[i].num_vectors = mem_nums[i];
-    msgs[i].num_control_messages = 0;
-    msgs[i].bytes_sent = 0;
-    msgs[i].control_messages = NULL;
-    msgs[i].address = clients[0]->addr;
+    templ[i].vectors = &vecs[mem];
+    templ[i].num_vectors = mem_nums[i];
+    templ[i].num_control_messages = 0;
+    templ[i].bytes_sent = 0;
+    templ[i].control_messages = NULL;
+    templ[i].address = NULL;
     mem += mem_nums[i];
   }
 
   /* FIXME: how about some locking? (there wasn't any before either, but..) */
   sink->bytes_to_serve += size;
 
-  /* now copy the pre-filled num_buffer messages over to the next num_buffer
-   * messages for the next client, where we also change the target address */
-  for (i = 1; i < num_addr; ++i) {
-    for (j = 0; j < num_buffers; ++j) {
-      msgs[i * num_buffers + j] = msgs[j];
-      msgs[i * num_buffers + j].address = clients[i]->addr;
-    }
-  }
-
   /* now send it! */
+  for (first = 0; first < num_addr; first = last) {
+    last = MIN (first + clients_per_shard, num_addr);
 
-  /* no IPv4 socket? Send it all from the IPv6 socket then.. */
-  if (sink->used_socket == NULL) {
-    flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
-        msgs, num_msgs);
-  } else {
-    guint num_msgs_v4 = num_buffers * num_addr_v4;
-    guint num_msgs_v6 = num_buffers * num_addr_v6;
-
-    /* our client list is sorted with IPv4 clients first and IPv6 ones last */
-    flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket,
-        msgs, num_msgs_v4);
-
+    flow_ret = gst_multiudpsink_send_shard (sink, snapshot, first, last,
+        templ, num_buffers, msgs);
     if (flow_ret != GST_FLOW_OK)
       goto cancelled;
 
-    flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
-        msgs + num_msgs_v4, num_msgs_v6);
-  }
-
-  if (flow_ret != GST_FLOW_OK)
-    goto cancelled;
-
-  /* now update stats */
-  g_mutex_lock (&sink->client_lock);
-
-  for (i = 0; i < num_addr; ++i) {
-    GstUDPClient *client = clients[i];
+    /* now update stats */
+    g_mutex_lock (&sink->client_lock);
+    for (i = first; i < last; ++i) {
+      GstUDPClient *client = snapshot->clients[i];
 
-    for (j = 0; j < num_buffers; ++j) {
-      gsize bytes_sent;
+      for (j = 0; j < num_buffers; ++j) {
+        gsize bytes_sent;
 
-      bytes_sent = msgs[i * num_buffers + j].bytes_sent;
+        bytes_sent = msgs[(i - first) * num_buffers + j].bytes_sent;
 
-      client->bytes_sent += bytes_sent;
-      client->packets_sent++;
-      sink->bytes_served += bytes_sent;
+        client->bytes_sent += bytes_sent;
+        client->packets_sent++;
+        sink->bytes_served += bytes_sent;
+      }
     }
-    gst_udp_client_unref (client);
+    g_mutex_unlock (&sink->client_lock);
   }
 
-  g_mutex_unlock (&sink->client_lock);
-
 out:
 
   for (i = 0; i < mem; ++i)
     gst_memory_unmap (map_infos[i].memory, &map_infos[i]);
 
+  g_mutex_lock (&sink->client_lock);
+  gst_udp_client_snapshot_unref (snapshot);
+  g_mutex_unlock (&sink->client_lock);
+
   return flow_ret;
 
 no_clients:
   {
+    g_mutex_lock (&sink->client_lock);
+    gst_udp_client_snapshot_unref (snapshot);
     g_mutex_unlock (&sink->client_lock);
     GST_LOG_OBJECT (sink, "no clients");
     return GST_FLOW_OK;
@@ -868,11 +945,6 @@ no_clients:
 cancelled:
   {
     GST_INFO_OBJECT (sink, "cancelled");
-
-    g_mutex_lock (&sink->client_lock);
-    for (i = 0; i < num_addr; ++i)
-      gst_udp_client_unref (clients[i]);
-    g_mutex_unlock (&sink->client_lock);
     goto out;
   }
 }
@@ -1584,6 +1656,8 @@ gst_multiudpsink_add_internal (GstMultiUDPSink * sink, const gchar * host,
   else
     ++sink->num_v6_all;
 
+  gst_multiudpsink_invalidate_snapshot (sink);
+
   if (lock)
     g_mutex_unlock (&sink->client_lock);
 
@@ -1640,6 +1714,8 @@ gst_multiudpsink_remove (GstMultiUDPSink * sink, const gchar * host, gint port)
   else
     --sink->num_v6_all;
 
+  gst_multiudpsink_invalidate_snapshot (sink);
+
   if (client->add_count == 0) {
     GInetSocketAddress *saddr = G_INET_SOCKET_ADDRESS (client->addr);
     GInetAddress *addr = g_inet_socket_address_get_address (saddr);
@@ -1713,6 +1789,7 @@ gst_multiudpsink_clear_internal (GstMultiUDPSink * sink, gboolean lock)
    * socket or anything to free for UDP */
   if (lock)
     g_mutex_lock (&sink->client_lock);
+  gst_multiudpsink_invalidate_snapshot (sink);
   g_list_foreach (sink->clients, (GFunc) gst_udp_client_unref, sink);
   g_list_free (sink->clients);
   sink->clients = NULL;
@@ -55,6 +55,19 @@ typedef struct {
   guint64 disconnect_time;
 } GstUDPClient;
 
+/* Immutable list of the clients to send to, with IPv4 clients first and
+ * duplicates expanded if needed. Shared between the streaming thread and
+ * client management so that rendering doesn't need to hold the client lock
+ * while sending. */
+typedef struct {
+  gint ref_count;
+
+  gboolean send_duplicates;
+  guint num_v4;
+  guint num_v6;
+  GstUDPClient **clients;
+} GstUDPClientSnapshot;
+
 /* sends udp packets to multiple host/port pairs.
  */
 struct _GstMultiUDPSink {
@@ -73,6 +86,8 @@ struct _GstMultiUDPSink {
   guint          num_v6_unique;  /* number IPv6 clients (excluding duplicates) */
   guint          num_v6_all;     /* number IPv6 clients (including duplicates) */
   GList         *clients_to_be_removed;
+  /* snapshot of @clients for the render function, NULL if outdated */
+  GstUDPClientSnapshot *clients_snapshot;
 
   /* pre-allocated scrap space for render function */
   GOutputVector    *vecs;
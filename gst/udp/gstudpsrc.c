@@ -476,7 +476,7 @@ gst_socket_timestamp_message_deserialize (gint level,
 {
   GstSocketTimestampMessage *message;
 
-  if (level != SOL_SOCKET)
+  if (level != SOL_SOCKET || type != SCM_TIMESTAMPNS)
     return NULL;
 
   if (size < sizeof (struct timespec))
@@ -506,6 +506,89 @@ gst_socket_timestamp_message_class_init (GstSocketTimestampMessageClass * class)
 }
 #endif
 
+#ifdef SO_RXQ_OVFL
+GType gst_socket_rxq_ovfl_message_get_type (void);
+
+#define GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE          (gst_socket_rxq_ovfl_message_get_type ())
+#define GST_SOCKET_RXQ_OVFL_MESSAGE(o)            (G_TYPE_CHECK_INSTANCE_CAST ((o), GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE, GstSocketRxqOvflMessage))
+#define GST_SOCKET_RXQ_OVFL_MESSAGE_CLASS(c)      (G_TYPE_CHECK_CLASS_CAST ((c), GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE, GstSocketRxqOvflMessageClass))
+#define GST_IS_SOCKET_RXQ_OVFL_MESSAGE(o)         (G_TYPE_CHECK_INSTANCE_TYPE ((o), GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE))
+#define GST_IS_SOCKET_RXQ_OVFL_MESSAGE_CLASS(c)   (G_TYPE_CHECK_CLASS_TYPE ((c), GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE))
+#define GST_SOCKET_RXQ_OVFL_MESSAGE_GET_CLASS(o)  (G_TYPE_INSTANCE_GET_CLASS ((o), GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE, GstSocketRxqOvflMessageClass))
+
+typedef struct _GstSocketRxqOvflMessage GstSocketRxqOvflMessage;
+typedef struct _GstSocketRxqOvflMessageClass GstSocketRxqOvflMessageClass;
+
+struct _GstSocketRxqOvflMessageClass
+{
+  GSocketControlMessageClass parent_class;
+};
+
+/* Number of packets the kernel dropped on this socket so far, because the
+ * receive queue was full. Only sent along with a packet once it is non-zero */
+struct _GstSocketRxqOvflMessage
+{
+  GSocketControlMessage parent;
+  guint32 drops;
+};
+
+G_DEFINE_TYPE (GstSocketRxqOvflMessage, gst_socket_rxq_ovfl_message,
+    G_TYPE_SOCKET_CONTROL_MESSAGE);
+
+static gsize
+gst_socket_rxq_ovfl_message_get_size (GSocketControlMessage * message)
+{
+  return sizeof (guint32);
+}
+
+static int
+gst_socket_rxq_ovfl_message_get_level (GSocketControlMessage * message)
+{
+  return SOL_SOCKET;
+}
+
+static int
+gst_socket_rxq_ovfl_message_get_msg_type (GSocketControlMessage * message)
+{
+  return SO_RXQ_OVFL;
+}
+
+static GSocketControlMessage *
+gst_socket_rxq_ovfl_message_deserialize (gint level,
+    gint type, gsize size, gpointer data)
+{
+  GstSocketRxqOvflMessage *message;
+
+  if (level != SOL_SOCKET || type != SO_RXQ_OVFL)
+    return NULL;
+
+  if (size < sizeof (guint32))
+    return NULL;
+
+  message = g_object_new (GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE, NULL);
+  memcpy (&message->drops, data, sizeof (guint32));
+
+  return G_SOCKET_CONTROL_MESSAGE (message);
+}
+
+static void
+gst_socket_rxq_ovfl_message_init (GstSocketRxqOvflMessage * message)
+{
+}
+
+static void
+gst_socket_rxq_ovfl_message_class_init (GstSocketRxqOvflMessageClass * class)
+{
+  GSocketControlMessageClass *scm_class;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = gst_socket_rxq_ovfl_message_get_size;
+  scm_class->get_level = gst_socket_rxq_ovfl_message_get_level;
+  scm_class->get_type = gst_socket_rxq_ovfl_message_get_msg_type;
+  scm_class->deserialize = gst_socket_rxq_ovfl_message_deserialize;
+}
+#endif
+
 static gboolean
 gst_udpsrc_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
 {
@@ -570,6 +653,13 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 #define UDP_DEFAULT_LOOP               TRUE
 #define UDP_DEFAULT_RETRIEVE_SENDER_ADDRESS TRUE
 #define UDP_DEFAULT_MTU                (1492)
+#define UDP_DEFAULT_REPORT_KERNEL_DROPS FALSE
+
+/* How often the offset between CLOCK_REALTIME and the pipeline clock is
+ * sampled again, and by how much a sample may deviate from the current
+ * estimate before we consider one of the clocks to have been stepped */
+#define UDP_REALTIME_RESAMPLE_INTERVAL (100 * GST_MSECOND)
+#define UDP_REALTIME_MAX_DRIFT         (GST_MSECOND)
 
 enum
 {
@@ -593,11 +683,14 @@ enum
   PROP_RETRIEVE_SENDER_ADDRESS,
   PROP_MTU,
   PROP_SOCKET_TIMESTAMP,
+  PROP_STATS,
+  PROP_REPORT_KERNEL_DROPS,
 };
 
 static void gst_udpsrc_uri_handler_init (gpointer g_iface, gpointer iface_data);
 
 static GstCaps *gst_udpsrc_getcaps (GstBaseSrc * src, GstCaps * filter);
+static GstStructure *gst_udpsrc_create_stats (GstUDPSrc * src);
 static gboolean gst_udpsrc_close (GstUDPSrc * src);
 static gboolean gst_udpsrc_unlock (GstBaseSrc * bsrc);
 static gboolean gst_udpsrc_unlock_stop (GstBaseSrc * bsrc);
@@ -646,6 +739,9 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
 #ifdef SO_TIMESTAMPNS
   GST_TYPE_SOCKET_TIMESTAMP_MESSAGE;
 #endif
+#ifdef SO_RXQ_OVFL
+  GST_TYPE_SOCKET_RXQ_OVFL_MESSAGE;
+#endif
 
   gobject_class->set_property = gst_udpsrc_set_property;
   gobject_class->get_property = gst_udpsrc_get_property;
@@ -779,6 +875,44 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
           GST_SOCKET_TIMESTAMP_MODE, GST_SOCKET_TIMESTAMP_MODE_REALTIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstUDPSrc:stats:
+   *
+   * Various statistics about the socket. This property returns a
+   * GstStructure with name application/x-udpsrc-stats with the following
+   * fields:
+   *
+   * - "packets-received" G_TYPE_UINT64: number of packets read from the socket
+   * - "kernel-drops" G_TYPE_UINT64: number of packets the kernel dropped
+   *   because the socket receive buffer was full. Only counted if
+   *   #GstUDPSrc:report-kernel-drops is enabled and SO_RXQ_OVFL is
+   *   available, and only updated when the next packet is received after
+   *   the drops.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics", "Various statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstUDPSrc:report-kernel-drops:
+   *
+   * Ask the kernel to report the packets it dropped because the socket
+   * receive buffer was full, and count them in #GstUDPSrc:stats. This uses
+   * SO_RXQ_OVFL and also applies to a socket set with #GstUDPSrc:socket.
+   *
+   * Drops that happened on a provided socket before the element started
+   * are not counted.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_REPORT_KERNEL_DROPS,
+      g_param_spec_boolean ("report-kernel-drops", "Report kernel drops",
+          "Count the packets dropped by the kernel in the stats",
+          UDP_DEFAULT_REPORT_KERNEL_DROPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class, &src_template);
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -820,6 +954,7 @@ gst_udpsrc_init (GstUDPSrc * udpsrc)
   udpsrc->reuse = UDP_DEFAULT_REUSE;
   udpsrc->loop = UDP_DEFAULT_LOOP;
   udpsrc->retrieve_sender_address = UDP_DEFAULT_RETRIEVE_SENDER_ADDRESS;
+  udpsrc->report_kernel_drops = UDP_DEFAULT_REPORT_KERNEL_DROPS;
   udpsrc->mtu = UDP_DEFAULT_MTU;
 
   /* configure basesrc to be a live source */
@@ -912,6 +1047,72 @@ gst_udpsrc_free_cancellable (GstUDPSrc * src)
   src->cancellable = NULL;
 }
 
+#ifdef SO_TIMESTAMPNS
+/* Maps a CLOCK_REALTIME socket timestamp to running time. The offset between
+ * CLOCK_REALTIME and the pipeline clock is not sampled for every packet but
+ * tracked over time, so that the time between reading both clocks does not
+ * add jitter to the timestamps while slow drift is still followed. */
+static GstClockTime
+gst_udpsrc_socket_ts_to_running_time (GstUDPSrc * udpsrc,
+    GstClockTime socket_ts)
+{
+  GstClock *clock;
+  GstClockTime base_time, now_real;
+  gint64 now, ts;
+
+  clock = gst_element_get_clock (GST_ELEMENT_CAST (udpsrc));
+  if (clock == NULL)
+    return GST_CLOCK_TIME_NONE;
+
+  base_time = gst_element_get_base_time (GST_ELEMENT_CAST (udpsrc));
+  now_real = g_get_real_time () * GST_USECOND;
+
+  if (!GST_CLOCK_TIME_IS_VALID (udpsrc->realtime_offset_time)
+      || now_real < udpsrc->realtime_offset_time || now_real < socket_ts
+      || now_real - udpsrc->realtime_offset_time >=
+      UDP_REALTIME_RESAMPLE_INTERVAL) {
+    gint64 sample;
+
+    sample = (gint64) gst_clock_get_time (clock) - (gint64) now_real;
+
+    if (GST_CLOCK_TIME_IS_VALID (udpsrc->realtime_offset_time)
+        && now_real >= udpsrc->realtime_offset_time
+        && ABS (sample - udpsrc->realtime_offset) < UDP_REALTIME_MAX_DRIFT) {
+      udpsrc->realtime_offset += (sample - udpsrc->realtime_offset) / 4;
+    } else {
+      GST_DEBUG_OBJECT (udpsrc, "Resetting realtime offset to %"
+          G_GINT64_FORMAT, sample);
+      udpsrc->realtime_offset = sample;
+    }
+    udpsrc->realtime_offset_time = now_real;
+  }
+  gst_object_unref (clock);
+
+  now = (gint64) now_real + udpsrc->realtime_offset;
+
+  if (now_real < socket_ts) {
+    /*
+     * The current system time will always be greater than the SCM
+     * timestamp as the packet would have been timestamped at least
+     * some clock cycles before. If it is not, then the system time
+     * was adjusted and we use the current running time instead.
+     */
+    GST_LOG_OBJECT (udpsrc,
+        "Current system time is behind SCM timestamp, using current time");
+    ts = now;
+  } else {
+    ts = (gint64) socket_ts + udpsrc->realtime_offset;
+    if (ts < (gint64) base_time) {
+      GST_LOG_OBJECT (udpsrc,
+          "SCM timestamp is before base time, using current time");
+      ts = now;
+    }
+  }
+
+  return ts > (gint64) base_time ? ts - base_time : 0;
+}
+#endif
+
 static GstFlowReturn
 gst_udpsrc_fill (GstPushSrc * psrc, GstBuffer * outbuf)
 {
@@ -946,6 +1147,10 @@ gst_udpsrc_fill (GstPushSrc * psrc, GstBuffer * outbuf)
   if (udpsrc->socket_timestamp_mode == GST_SOCKET_TIMESTAMP_MODE_REALTIME)
     p_msgs = &msgs;
 #endif
+#ifdef SO_RXQ_OVFL
+  if (udpsrc->rxq_ovfl)
+    p_msgs = &msgs;
+#endif
 
   /* Retrieve sender address unless we've been configured not to do so */
   p_saddr = (udpsrc->retrieve_sender_address) ? &saddr : NULL;
@@ -1076,64 +1281,44 @@ retry:
 #ifdef SO_TIMESTAMPNS
       if (GST_IS_SOCKET_TIMESTAMP_MESSAGE (msgs[i])) {
         GstSocketTimestampMessage *msg = GST_SOCKET_TIMESTAMP_MESSAGE (msgs[i]);
-        GstClock *clock;
-        GstClockTime socket_ts;
+        GstClockTime socket_ts, dts;
 
         socket_ts = GST_TIMESPEC_TO_TIME (msg->socket_ts);
         GST_TRACE_OBJECT (udpsrc,
             "Got SCM_TIMESTAMPNS %" GST_TIME_FORMAT " in msg",
             GST_TIME_ARGS (socket_ts));
 
-        clock = gst_element_get_clock (GST_ELEMENT_CAST (udpsrc));
-        if (clock != NULL) {
-          gint64 adjust_dts, cur_sys_time, delta;
-          GstClockTime base_time, cur_gst_clk_time, running_time;
-
-          /*
-           * We use g_get_real_time as the time reference for SCM timestamps
-           * is always CLOCK_REALTIME.
-           */
-          cur_sys_time = g_get_real_time () * GST_USECOND;
-          cur_gst_clk_time = gst_clock_get_time (clock);
-
-          delta = (gint64) cur_sys_time - (gint64) socket_ts;
-          if (delta < 0) {
-            /*
-             * The current system time will always be greater than the SCM
-             * timestamp as the packet would have been timestamped at least
-             * some clock cycles before. If it is not, then the system time
-             * was adjusted. Since we cannot rely on the delta calculation in
-             * such a case, set the DTS to current pipeline clock when this
-             * happens.
-             */
-            GST_LOG_OBJECT (udpsrc,
-                "Current system time is behind SCM timestamp, setting DTS to pipeline clock");
-            GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
-          } else {
-            base_time = gst_element_get_base_time (GST_ELEMENT_CAST (udpsrc));
-            running_time = cur_gst_clk_time - base_time;
-            adjust_dts = (gint64) running_time - delta;
-            /*
-             * If the system time was adjusted much further ahead, we might
-             * end up with delta > cur_gst_clk_time. Set the DTS to current
-             * pipeline clock for this scenario as well.
-             */
-            if (adjust_dts < 0) {
-              GST_LOG_OBJECT (udpsrc,
-                  "Current system time much ahead in time, setting DTS to pipeline clock");
-              GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
-            } else {
-              GST_BUFFER_DTS (outbuf) = adjust_dts;
-              GST_LOG_OBJECT (udpsrc, "Setting DTS to %" GST_TIME_FORMAT,
-                  GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)));
-            }
-          }
-          g_object_unref (clock);
+        dts = gst_udpsrc_socket_ts_to_running_time (udpsrc, socket_ts);
+        if (GST_CLOCK_TIME_IS_VALID (dts)) {
+          GST_BUFFER_DTS (outbuf) = dts;
+          GST_LOG_OBJECT (udpsrc, "Setting DTS to %" GST_TIME_FORMAT,
+              GST_TIME_ARGS (dts));
         } else {
           GST_ERROR_OBJECT (udpsrc,
               "Failed to get element clock, not setting DTS");
         }
       }
+#endif
+#ifdef SO_RXQ_OVFL
+      if (GST_IS_SOCKET_RXQ_OVFL_MESSAGE (msgs[i])) {
+        GstSocketRxqOvflMessage *msg = GST_SOCKET_RXQ_OVFL_MESSAGE (msgs[i]);
+
+        /* the kernel reports the total since the socket was created, and it
+         * may wrap around. On a provided socket the first report also
+         * contains the drops from before we started */
+        if (!udpsrc->have_last_rxq_ovfl) {
+          udpsrc->last_rxq_ovfl = msg->drops;
+          udpsrc->have_last_rxq_ovfl = TRUE;
+        } else if (msg->drops != udpsrc->last_rxq_ovfl) {
+          guint32 drops = msg->drops - udpsrc->last_rxq_ovfl;
+
+          GST_DEBUG_OBJECT (udpsrc, "Kernel dropped %u packets", drops);
+          GST_OBJECT_LOCK (udpsrc);
+          udpsrc->kernel_drops += drops;
+          GST_OBJECT_UNLOCK (udpsrc);
+          udpsrc->last_rxq_ovfl = msg->drops;
+        }
+      }
 #endif
     }
 
@@ -1167,6 +1352,10 @@ retry:
 
   gst_buffer_resize (outbuf, offset, res - offset);
 
+  GST_OBJECT_LOCK (udpsrc);
+  udpsrc->packets_received++;
+  GST_OBJECT_UNLOCK (udpsrc);
+
   /* use buffer metadata so receivers can also track the address */
   if (saddr) {
     gst_buffer_add_net_address_meta (outbuf, saddr);
@@ -1374,6 +1563,9 @@ gst_udpsrc_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_SOCKET_TIMESTAMP:
       udpsrc->socket_timestamp_mode = g_value_get_enum (value);
       break;
+    case PROP_REPORT_KERNEL_DROPS:
+      udpsrc->report_kernel_drops = g_value_get_boolean (value);
+      break;
     default:
       break;
   }
@@ -1440,12 +1632,32 @@ gst_udpsrc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SOCKET_TIMESTAMP:
       g_value_set_enum (value, udpsrc->socket_timestamp_mode);
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_udpsrc_create_stats (udpsrc));
+      break;
+    case PROP_REPORT_KERNEL_DROPS:
+      g_value_set_boolean (value, udpsrc->report_kernel_drops);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static GstStructure *
+gst_udpsrc_create_stats (GstUDPSrc * src)
+{
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (src);
+  s = gst_structure_new ("application/x-udpsrc-stats",
+      "packets-received", G_TYPE_UINT64, src->packets_received,
+      "kernel-drops", G_TYPE_UINT64, src->kernel_drops, NULL);
+  GST_OBJECT_UNLOCK (src);
+
+  return s;
+}
+
 static GInetAddress *
 gst_udpsrc_resolve (GstUDPSrc * src, const gchar * address)
 {
@@ -1520,6 +1732,16 @@ gst_udpsrc_open (GstUDPSrc * src)
 
   gst_udpsrc_create_cancellable (src);
 
+  GST_OBJECT_LOCK (src);
+  src->packets_received = 0;
+  src->kernel_drops = 0;
+  GST_OBJECT_UNLOCK (src);
+  src->last_rxq_ovfl = 0;
+  src->have_last_rxq_ovfl = FALSE;
+  src->rxq_ovfl = FALSE;
+  src->realtime_offset = 0;
+  src->realtime_offset_time = GST_CLOCK_TIME_NONE;
+
   if (src->socket == NULL) {
     /* need to allocate a socket */
     GST_DEBUG_OBJECT (src, "allocating socket for %s:%d", src->address,
@@ -1753,6 +1975,25 @@ gst_udpsrc_open (GstUDPSrc * src)
   }
 #endif
 
+  if (src->report_kernel_drops) {
+#ifdef SO_RXQ_OVFL
+    src->rxq_ovfl = g_socket_set_option (src->used_socket, SOL_SOCKET,
+        SO_RXQ_OVFL, TRUE, &err);
+    if (!src->rxq_ovfl) {
+      GST_WARNING_OBJECT (src, "Failed to enable SO_RXQ_OVFL: %s",
+          err->message);
+      g_clear_error (&err);
+    } else {
+      GST_LOG_OBJECT (src, "Kernel drop reporting enabled");
+      /* a socket we created has not dropped anything yet */
+      src->have_last_rxq_ovfl = !src->external_socket;
+    }
+#else
+    GST_WARNING_OBJECT (src,
+        "report-kernel-drops was requested but SO_RXQ_OVFL is not defined");
+#endif
+  }
+
   /* NOTE: sockaddr_in.sin_port works for ipv4 and ipv6 because sin_port
    * follows ss_family on both */
   {
@@ -86,6 +86,16 @@ struct _GstUDPSrc {
 
   /* stats */
   guint      max_size;
+  guint64    packets_received;
+  guint64    kernel_drops;
+  guint32    last_rxq_ovfl;
+  gboolean   have_last_rxq_ovfl;
+  gboolean   rxq_ovfl;
+  gboolean   report_kernel_drops;
+
+  /* pipeline clock minus CLOCK_REALTIME, and the realtime it was sampled at */
+  gint64       realtime_offset;
+  GstClockTime realtime_offset_time;
 
   gboolean   external_socket;
   gboolean   made_cancel_fd;
@@ -0,0 +1,256 @@
+/* GStreamer unit test for the cairooverlay element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#include <cairo.h>
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define VIDEO_CAPS_STR \
+  "video/x-raw,format=BGRx,width=64,height=48,framerate=30/1"
+#else
+#define VIDEO_CAPS_STR \
+  "video/x-raw,format=xRGB,width=64,height=48,framerate=30/1"
+#endif
+
+#define RECT_X 8
+#define RECT_Y 8
+#define RECT_W 16
+#define RECT_H 16
+
+/* a second position that does not overlap the first one */
+#define RECT2_X 40
+#define RECT2_Y 24
+
+typedef struct
+{
+  gboolean keep_previous;
+  gint x, y;
+} DrawState;
+
+static void
+draw_rect (GstElement * overlay, cairo_t * cr, guint64 timestamp,
+    guint64 duration, gpointer user_data)
+{
+  DrawState *state = user_data;
+
+  if (state->keep_previous) {
+    g_signal_emit_by_name (overlay, "keep-previous");
+    return;
+  }
+
+  cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+  cairo_rectangle (cr, state->x, state->y, RECT_W, RECT_H);
+  cairo_fill (cr);
+
+  g_signal_emit_by_name (overlay, "report-damage", state->x, state->y,
+      RECT_W, RECT_H);
+}
+
+static GstHarness *
+setup_overlay (DrawState * state)
+{
+  GstHarness *h = gst_harness_new ("cairooverlay");
+
+  g_object_set (h->element, "draw-on-transparent-surface", TRUE, NULL);
+  g_signal_connect (h->element, "draw", G_CALLBACK (draw_rect), state);
+  gst_harness_set_src_caps_str (h, VIDEO_CAPS_STR);
+
+  return h;
+}
+
+static GstBuffer *
+create_black_frame (GstHarness * h)
+{
+  GstBuffer *buf = gst_harness_create_buffer (h, 64 * 48 * 4);
+
+  gst_buffer_memset (buf, 0, 0, 64 * 48 * 4);
+
+  return buf;
+}
+
+static void
+check_blended_frame (GstBuffer * buf, gint rect_x, gint rect_y)
+{
+  GstCaps *caps = gst_caps_from_string (VIDEO_CAPS_STR);
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  gint x, y, c;
+
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_READ));
+
+  for (y = 0; y < 48; y++) {
+    for (x = 0; x < 64; x++) {
+      gboolean inside = x >= rect_x && x < rect_x + RECT_W &&
+          y >= rect_y && y < rect_y + RECT_H;
+      guint8 *pixel = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0) + x * 4;
+
+      for (c = 0; c < 3; c++) {
+        fail_unless_equals_int (pixel[GST_VIDEO_FRAME_COMP_POFFSET (&frame,
+                    c)], inside ? 255 : 0);
+      }
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+}
+
+GST_START_TEST (test_damage_blend)
+{
+  DrawState state = { FALSE, RECT_X, RECT_Y };
+  GstHarness *h = setup_overlay (&state);
+  GstBuffer *buf;
+
+  buf = gst_harness_push_and_pull (h, create_black_frame (h));
+  check_blended_frame (buf, RECT_X, RECT_Y);
+  gst_buffer_unref (buf);
+
+  /* the previous overlay is blended again */
+  state.keep_previous = TRUE;
+  buf = gst_harness_push_and_pull (h, create_black_frame (h));
+  check_blended_frame (buf, RECT_X, RECT_Y);
+  gst_buffer_unref (buf);
+
+  /* and a recycled surface only contains the new drawing */
+  state.keep_previous = FALSE;
+  buf = gst_harness_push_and_pull (h, create_black_frame (h));
+  check_blended_frame (buf, RECT_X, RECT_Y);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_damage_recycle_partial)
+{
+  DrawState state = { FALSE, RECT_X, RECT_Y };
+  GstHarness *h = setup_overlay (&state);
+  GstBuffer *buf;
+  gint i;
+
+  /* the surface of each frame is kept for the next frame's keep-previous,
+   * so from the third frame on the surface of the frame before the previous
+   * one is recycled. Switching the position every two frames means that it
+   * was drawn on at the other position, which must be cleared without
+   * clearing the whole surface */
+  for (i = 0; i < 6; i++) {
+    state.x = ((i / 2) % 2) ? RECT2_X : RECT_X;
+    state.y = ((i / 2) % 2) ? RECT2_Y : RECT_Y;
+
+    buf = gst_harness_push_and_pull (h, create_black_frame (h));
+    check_blended_frame (buf, state.x, state.y);
+    gst_buffer_unref (buf);
+  }
+
+  /* frames that keep the previous overlay return their surface unused, it
+   * has nothing to clear and must still be transparent when drawn on again */
+  state.keep_previous = TRUE;
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_push_and_pull (h, create_black_frame (h));
+    check_blended_frame (buf, state.x, state.y);
+    gst_buffer_unref (buf);
+  }
+
+  state.keep_previous = FALSE;
+  state.x = RECT_X;
+  state.y = RECT_Y;
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_push_and_pull (h, create_black_frame (h));
+    check_blended_frame (buf, RECT_X, RECT_Y);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_damage_composition_meta)
+{
+  DrawState state = { FALSE, RECT_X, RECT_Y };
+  GstHarness *h;
+  GstBuffer *buf;
+  GstVideoOverlayCompositionMeta *meta;
+  GstVideoOverlayRectangle *rect, *first_rect;
+  gint x, y;
+  guint width, height;
+
+  h = gst_harness_new ("cairooverlay");
+  gst_harness_add_propose_allocation_meta (h,
+      GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+  g_object_set (h->element, "draw-on-transparent-surface", TRUE, NULL);
+  g_signal_connect (h->element, "draw", G_CALLBACK (draw_rect), &state);
+  gst_harness_set_src_caps_str (h, VIDEO_CAPS_STR);
+
+  buf = gst_harness_push_and_pull (h, create_black_frame (h));
+  meta = gst_buffer_get_video_overlay_composition_meta (buf);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (gst_video_overlay_composition_n_rectangles
+      (meta->overlay), 1);
+
+  /* only the damaged area ends up in the rectangle */
+  first_rect = gst_video_overlay_composition_get_rectangle (meta->overlay, 0);
+  fail_unless (gst_video_overlay_rectangle_get_render_rectangle (first_rect,
+          &x, &y, &width, &height));
+  fail_unless_equals_int (x, RECT_X);
+  fail_unless_equals_int (y, RECT_Y);
+  fail_unless_equals_int (width, RECT_W);
+  fail_unless_equals_int (height, RECT_H);
+  gst_video_overlay_rectangle_ref (first_rect);
+  gst_buffer_unref (buf);
+
+  /* an unchanged overlay reuses the previous rectangle */
+  state.keep_previous = TRUE;
+  buf = gst_harness_push_and_pull (h, create_black_frame (h));
+  meta = gst_buffer_get_video_overlay_composition_meta (buf);
+  fail_unless (meta != NULL);
+  rect = gst_video_overlay_composition_get_rectangle (meta->overlay, 0);
+  fail_unless (rect == first_rect);
+  gst_buffer_unref (buf);
+
+  gst_video_overlay_rectangle_unref (first_rect);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+cairooverlay_suite (void)
+{
+  Suite *s = suite_create ("cairooverlay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_damage_blend);
+  tcase_add_test (tc_chain, test_damage_recycle_partial);
+  tcase_add_test (tc_chain, test_damage_composition_meta);
+
+  return s;
+}
+
+GST_CHECK_MAIN (cairooverlay);
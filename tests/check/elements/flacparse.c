@@ -24,6 +24,7 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/check.h>
 #include "parser.h"
 
 #define SRC_CAPS_TMPL  "audio/x-flac, framed=(boolean)false"
@@ -188,6 +189,57 @@ GST_START_TEST (test_parse_flac_skip_garbage)
 
 GST_END_TEST;
 
+/*
+ * Test that a frame whose CRC-16 does not match its data is not output when
+ * frame checksums are checked.
+ */
+GST_START_TEST (test_parse_flac_frame_crc_mismatch)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint8 frame[sizeof (flac_frame)];
+  guint frames = 0;
+
+  /* flip a bit of the CRC-16 at the end of the frame */
+  memcpy (frame, flac_frame, sizeof (flac_frame));
+  frame[sizeof (frame) - 1] ^= 0x01;
+
+  h = gst_harness_new_parse ("flacparse check-frame-checksums=true");
+  gst_harness_set_src_caps_str (h, SRC_CAPS_TMPL);
+
+  fail_unless_equals_int (gst_harness_push (h,
+          gst_buffer_new_memdup (streaminfo_header,
+              sizeof (streaminfo_header))), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h,
+          gst_buffer_new_memdup (comment_header, sizeof (comment_header))),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h,
+          gst_buffer_new_memdup (flac_frame, sizeof (flac_frame))),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h,
+          gst_buffer_new_memdup (frame, sizeof (frame))), GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  /* only the intact frame comes out after the headers */
+  while ((buf = gst_harness_try_pull (h))) {
+    guint8 sync[2];
+
+    if (gst_buffer_extract (buf, 0, sync, 2) == 2
+        && (GST_READ_UINT16_BE (sync) & 0xfffe) == 0xfff8) {
+      fail_unless_equals_int (gst_buffer_get_size (buf), sizeof (flac_frame));
+      fail_unless (gst_buffer_memcmp (buf, 0, flac_frame,
+              sizeof (flac_frame)) == 0);
+      frames++;
+    }
+    gst_buffer_unref (buf);
+  }
+  fail_unless_equals_int (frames, 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 
 #define structure_get_int(s,f) \
     (g_value_get_int(gst_structure_get_value(s,f)))
@@ -269,6 +321,7 @@ flacparse_suite (void)
   tcase_add_test (tc_chain, test_parse_flac_drain_garbage);
   tcase_add_test (tc_chain, test_parse_flac_split);
   tcase_add_test (tc_chain, test_parse_flac_skip_garbage);
+  tcase_add_test (tc_chain, test_parse_flac_frame_crc_mismatch);
 
   /* Other tests */
   tcase_add_test (tc_chain, test_parse_flac_detect_stream);
@@ -0,0 +1,104 @@
+/* GStreamer unit test for the goom zoom filter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+/* for the static c_zoom() and generatePrecalCoef() */
+#include "../../../gst/goom/filters.c"
+
+/* renders a fixed random frame with zoom_filter_c(), which uses the stripe
+ * pool for frames of this size, and with a single c_zoom() call over the
+ * whole frame and checks that both give the same output */
+static void
+check_zoom_filter (int sizeX, int sizeY)
+{
+  int precalCoef[BUFFPOINTNB][BUFFPOINTNB];
+  Pixel *src, *dest, *ref;
+  int *brutS, *brutD;
+  int ax = (sizeX - 1) << PERTEDEC, ay = (sizeY - 1) << PERTEDEC;
+  int buffratio = BUFFPOINTMASK / 3;
+  GRand *rand;
+  int i;
+
+  rand = g_rand_new_with_seed (sizeX * sizeY);
+  generatePrecalCoef (precalCoef);
+
+  src = g_new (Pixel, sizeX * sizeY);
+  dest = g_new0 (Pixel, sizeX * sizeY);
+  ref = g_new0 (Pixel, sizeX * sizeY);
+  brutS = g_new (int, sizeX * sizeY * 2);
+  brutD = g_new (int, sizeX * sizeY * 2);
+
+  for (i = 0; i < sizeX * sizeY; i++) {
+    src[i].val = g_rand_int (rand);
+
+    /* a few positions are out of range on purpose */
+    brutS[2 * i] = g_rand_int_range (rand, 0, ax + 32);
+    brutS[2 * i + 1] = g_rand_int_range (rand, 0, ay + 32);
+    brutD[2 * i] = g_rand_int_range (rand, 0, ax + 32);
+    brutD[2 * i + 1] = g_rand_int_range (rand, 0, ay + 32);
+  }
+
+  /* this also clears the source corners for the reference */
+  zoom_filter_c (sizeX, sizeY, src, dest, brutS, brutD, buffratio,
+      precalCoef);
+  c_zoom (src, ref, sizeX, sizeY, brutS, brutD, buffratio, precalCoef, 0,
+      sizeX * sizeY);
+
+  fail_unless (memcmp (dest, ref, sizeX * sizeY * sizeof (Pixel)) == 0);
+
+  g_free (src);
+  g_free (dest);
+  g_free (ref);
+  g_free (brutS);
+  g_free (brutD);
+  g_rand_free (rand);
+}
+
+GST_START_TEST (test_zoom_filter_stripes)
+{
+  /* on single core machines there is no pool and both are rendered in one
+   * pass */
+  if (zoom_get_stripe_pool () == NULL)
+    GST_INFO ("no stripe pool, rendering in one pass");
+
+  check_zoom_filter (640, 480);
+  check_zoom_filter (1280, 720);
+  /* the last stripe is smaller than the others */
+  check_zoom_filter (643, 487);
+}
+
+GST_END_TEST;
+
+static Suite *
+goom_suite (void)
+{
+  Suite *s = suite_create ("goom");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_zoom_filter_stripes);
+
+  return s;
+}
+
+GST_CHECK_MAIN (goom);
@@ -351,6 +351,48 @@ GST_START_TEST (test_timecodescale)
 
 GST_END_TEST;
 
+static guint
+count_clusters_with_max_size (guint64 max_cluster_size)
+{
+  GstHarness *h = setup_matroskamux_harness (AC3_CAPS_STRING);
+  const guint8 cluster_id[] = { 0x1f, 0x43, 0xb6, 0x75 };
+  GstBuffer *outbuffer;
+  guint n_clusters = 0;
+  gint i;
+
+  g_object_set (h->element, "streamable", TRUE,
+      "min-cluster-duration", (gint64) 10 * GST_SECOND,
+      "max-cluster-size", max_cluster_size, NULL);
+
+  for (i = 0; i < 10; i++) {
+    GstBuffer *inbuffer = gst_harness_create_buffer (h, 64);
+
+    GST_BUFFER_TIMESTAMP (inbuffer) = i * GST_MSECOND;
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, inbuffer));
+  }
+
+  while ((outbuffer = gst_harness_try_pull (h))) {
+    if (gst_buffer_get_size (outbuffer) >= sizeof (cluster_id) &&
+        gst_buffer_memcmp (outbuffer, 0, cluster_id, sizeof (cluster_id)) == 0)
+      n_clusters++;
+    gst_buffer_unref (outbuffer);
+  }
+
+  gst_harness_teardown (h);
+
+  return n_clusters;
+}
+
+GST_START_TEST (test_max_cluster_size)
+{
+  /* all buffers go into the first cluster without a size limit */
+  fail_unless_equals_int (count_clusters_with_max_size (0), 1);
+  /* about two blocks fit into a cluster with a limit of 100 bytes */
+  fail_unless (count_clusters_with_max_size (100) >= 4);
+}
+
+GST_END_TEST;
+
 /* Create a new chapter */
 static GstTocEntry *
 new_chapter (const guint chapter_nb, const gint64 start, const gint64 stop)
@@ -1012,6 +1054,7 @@ matroskamux_suite (void)
   tcase_add_loop_test (tc_chain, test_timecodescale,
       0, G_N_ELEMENTS (timecodescales));
 
+  tcase_add_test (tc_chain, test_max_cluster_size);
   tcase_add_test (tc_chain, test_toc_with_edition);
   tcase_add_test (tc_chain, test_toc_without_edition);
   return s;
@@ -0,0 +1,195 @@
+/* GStreamer unit test for the pulsesink element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+/* These tests need a running sound server, they are skipped otherwise */
+
+#define AUDIO_CAPS_STR \
+  "audio/x-raw,format=S16LE,layout=interleaved,rate=48000,channels=1"
+
+/* well below a segment with the default latency-time of 10ms */
+#define SMALL_BUFFER_SAMPLES 64
+
+/* sample values written before and after the seek */
+#define PRE_SEEK_VALUE 16384
+#define POST_SEEK_VALUE -16384
+#define LOUD_THRESHOLD 4096
+
+typedef struct
+{
+  gint saw_pre_seek;
+  gint saw_post_seek;
+} MonitorData;
+
+static gboolean
+have_sound_server (void)
+{
+  GstElement *sink;
+  GstStateChangeReturn ret;
+
+  sink = gst_element_factory_make ("pulsesink", NULL);
+  if (sink == NULL)
+    return FALSE;
+
+  ret = gst_element_set_state (sink, GST_STATE_READY);
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_object_unref (sink);
+
+  return ret != GST_STATE_CHANGE_FAILURE;
+}
+
+static GstFlowReturn
+monitor_new_sample (GstElement * appsink, MonitorData * data)
+{
+  GstSample *sample = NULL;
+  GstMapInfo map;
+  const gint16 *samples;
+  gsize i;
+
+  g_signal_emit_by_name (appsink, "pull-sample", &sample);
+  if (sample == NULL)
+    return GST_FLOW_EOS;
+
+  gst_buffer_map (gst_sample_get_buffer (sample), &map, GST_MAP_READ);
+  samples = (const gint16 *) map.data;
+  for (i = 0; i < map.size / sizeof (gint16); i++) {
+    if (samples[i] > LOUD_THRESHOLD)
+      g_atomic_int_set (&data->saw_pre_seek, TRUE);
+    else if (samples[i] < -LOUD_THRESHOLD)
+      g_atomic_int_set (&data->saw_post_seek, TRUE);
+  }
+  gst_buffer_unmap (gst_sample_get_buffer (sample), &map);
+  gst_sample_unref (sample);
+
+  return GST_FLOW_OK;
+}
+
+static GstBuffer *
+create_buffer (guint64 offset, guint n_samples, gint16 value)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, n_samples * 2, NULL);
+  GstMapInfo map;
+  guint i;
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (i = 0; i < n_samples; i++)
+    GST_WRITE_UINT16_LE (map.data + 2 * i, value);
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + n_samples;
+  GST_BUFFER_PTS (buf) = gst_util_uint64_scale_int (offset, GST_SECOND, 48000);
+  GST_BUFFER_DURATION (buf) =
+      gst_util_uint64_scale_int (n_samples, GST_SECOND, 48000);
+
+  return buf;
+}
+
+GST_START_TEST (test_flush_drops_pending)
+{
+  MonitorData data = { FALSE, FALSE };
+  GstElement *monitor, *appsink;
+  GstHarness *h;
+  GstSegment segment;
+  guint64 offset;
+  guint i;
+
+  if (!have_sound_server ()) {
+    GST_INFO ("no sound server, skipping");
+    return;
+  }
+
+  /* record what is actually played */
+  monitor = gst_parse_launch ("pulsesrc device=@DEFAULT_MONITOR@ ! "
+      AUDIO_CAPS_STR " ! appsink name=sink sync=false emit-signals=true",
+      NULL);
+  fail_unless (monitor != NULL);
+  appsink = gst_bin_get_by_name (GST_BIN (monitor), "sink");
+  g_signal_connect (appsink, "new-sample", G_CALLBACK (monitor_new_sample),
+      &data);
+  gst_object_unref (appsink);
+  fail_if (gst_element_set_state (monitor, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+
+  h = gst_harness_new ("pulsesink");
+  g_object_set (h->element, "sync", FALSE, "volume", 1.0, "mute", FALSE,
+      NULL);
+  gst_harness_set_src_caps_str (h, AUDIO_CAPS_STR);
+
+  /* a few commits smaller than a segment, these stay pending in the shared
+   * memory block */
+  offset = 0;
+  for (i = 0; i < 4; i++) {
+    fail_unless_equals_int (gst_harness_push (h,
+            create_buffer (offset, SMALL_BUFFER_SAMPLES, PRE_SEEK_VALUE)),
+        GST_FLOW_OK);
+    offset += SMALL_BUFFER_SAMPLES;
+  }
+
+  /* flushing seek back to the start */
+  fail_unless (gst_harness_push_event (h, gst_event_new_flush_start ()));
+  fail_unless (gst_harness_push_event (h, gst_event_new_flush_stop (TRUE)));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_harness_push_event (h, gst_event_new_segment (&segment)));
+
+  /* half a second of the new data */
+  offset = 0;
+  for (i = 0; i < 24000 / 480; i++) {
+    fail_unless_equals_int (gst_harness_push (h,
+            create_buffer (offset, 480, POST_SEEK_VALUE)), GST_FLOW_OK);
+    offset += 480;
+  }
+  /* waits until everything was played */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  g_usleep (G_USEC_PER_SEC / 4);
+
+  gst_harness_teardown (h);
+  gst_element_set_state (monitor, GST_STATE_NULL);
+  gst_object_unref (monitor);
+
+  if (!g_atomic_int_get (&data.saw_post_seek)) {
+    GST_INFO ("nothing recorded from the monitor, can't check the result");
+    return;
+  }
+
+  /* none of the data from before the seek was played */
+  fail_if (g_atomic_int_get (&data.saw_pre_seek));
+}
+
+GST_END_TEST;
+
+static Suite *
+pulsesink_suite (void)
+{
+  Suite *s = suite_create ("pulsesink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 20);
+  tcase_add_test (tc_chain, test_flush_drops_pending);
+
+  return s;
+}
+
+GST_CHECK_MAIN (pulsesink);
@@ -888,6 +888,452 @@ GST_START_TEST (test_qtdemux_pad_names)
 
 GST_END_TEST;
 
+/* Minimal ISO BMFF writer for building test streams */
+static guint
+box_start (GByteArray * ba, const gchar * fourcc)
+{
+  guint8 header[8] = { 0, };
+  guint pos = ba->len;
+
+  memcpy (header + 4, fourcc, 4);
+  g_byte_array_append (ba, header, 8);
+
+  return pos;
+}
+
+static void
+box_end (GByteArray * ba, guint pos)
+{
+  GST_WRITE_UINT32_BE (ba->data + pos, ba->len - pos);
+}
+
+static void
+put_uint8 (GByteArray * ba, guint8 val)
+{
+  g_byte_array_append (ba, &val, 1);
+}
+
+static void
+put_uint16 (GByteArray * ba, guint16 val)
+{
+  guint8 data[2];
+
+  GST_WRITE_UINT16_BE (data, val);
+  g_byte_array_append (ba, data, 2);
+}
+
+static void
+put_uint32 (GByteArray * ba, guint32 val)
+{
+  guint8 data[4];
+
+  GST_WRITE_UINT32_BE (data, val);
+  g_byte_array_append (ba, data, 4);
+}
+
+static void
+put_zeroes (GByteArray * ba, guint len)
+{
+  while (len--)
+    put_uint8 (ba, 0);
+}
+
+static void
+put_fourcc (GByteArray * ba, const gchar * fourcc)
+{
+  g_byte_array_append (ba, (const guint8 *) fourcc, 4);
+}
+
+static void
+put_matrix (GByteArray * ba)
+{
+  put_uint32 (ba, 0x00010000);
+  put_zeroes (ba, 12);
+  put_uint32 (ba, 0x00010000);
+  put_zeroes (ba, 12);
+  put_uint32 (ba, 0x40000000);
+}
+
+#define CENC_N_SAMPLES 4
+#define CENC_SAMPLE_SIZE 64
+#define CENC_IV_SIZE 8
+
+static const guint8 cenc_kid[16] = {
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+static const guint cenc_n_subsamples[CENC_N_SAMPLES] = { 1, 2, 0, 3 };
+
+static void
+put_cenc_sample_iv (GByteArray * ba, guint sample)
+{
+  guint i;
+
+  for (i = 0; i < CENC_IV_SIZE; i++)
+    put_uint8 (ba, 0xa0 + sample);
+}
+
+static void
+put_cenc_subsamples (GByteArray * ba, guint sample)
+{
+  guint i;
+
+  for (i = 0; i < cenc_n_subsamples[sample]; i++) {
+    /* clear and encrypted bytes */
+    put_uint16 (ba, 4 + i);
+    put_uint32 (ba, 16 + sample);
+  }
+}
+
+/* A fragmented stream with one cenc protected JPEG video track and one
+ * fragment whose sample auxiliary info is in a senc box */
+static GBytes *
+create_cenc_fragmented_stream (void)
+{
+  GByteArray *ba = g_byte_array_new ();
+  guint moov, trak, mdia, minf, dinf, dref, stbl, stsd, encv, sinf, schi;
+  guint mvex, box, moof, traf, trun_data_offset, saio_offset, senc_data, mdat;
+  guint i;
+
+  box = box_start (ba, "ftyp");
+  put_fourcc (ba, "iso6");
+  put_uint32 (ba, 0);
+  put_fourcc (ba, "iso6");
+  put_fourcc (ba, "isom");
+  box_end (ba, box);
+
+  moov = box_start (ba, "moov");
+
+  box = box_start (ba, "mvhd");
+  put_uint32 (ba, 0);
+  put_zeroes (ba, 8);
+  put_uint32 (ba, 1000);
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0x00010000);
+  put_uint16 (ba, 0x0100);
+  put_zeroes (ba, 10);
+  put_matrix (ba);
+  put_zeroes (ba, 24);
+  put_uint32 (ba, 2);
+  box_end (ba, box);
+
+  trak = box_start (ba, "trak");
+  box = box_start (ba, "tkhd");
+  put_uint32 (ba, 0x00000003);
+  put_zeroes (ba, 8);
+  put_uint32 (ba, 1);
+  put_zeroes (ba, 4);
+  put_uint32 (ba, 0);
+  put_zeroes (ba, 16);
+  put_matrix (ba);
+  put_uint32 (ba, 320 << 16);
+  put_uint32 (ba, 240 << 16);
+  box_end (ba, box);
+
+  mdia = box_start (ba, "mdia");
+  box = box_start (ba, "mdhd");
+  put_uint32 (ba, 0);
+  put_zeroes (ba, 8);
+  put_uint32 (ba, 25);
+  put_uint32 (ba, 0);
+  put_uint16 (ba, 0x55c4);
+  put_uint16 (ba, 0);
+  box_end (ba, box);
+
+  box = box_start (ba, "hdlr");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  put_fourcc (ba, "vide");
+  put_zeroes (ba, 12);
+  put_uint8 (ba, 0);
+  box_end (ba, box);
+
+  minf = box_start (ba, "minf");
+  box = box_start (ba, "vmhd");
+  put_uint32 (ba, 0x00000001);
+  put_zeroes (ba, 8);
+  box_end (ba, box);
+
+  dinf = box_start (ba, "dinf");
+  dref = box_start (ba, "dref");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 1);
+  box = box_start (ba, "url ");
+  put_uint32 (ba, 0x00000001);
+  box_end (ba, box);
+  box_end (ba, dref);
+  box_end (ba, dinf);
+
+  stbl = box_start (ba, "stbl");
+  stsd = box_start (ba, "stsd");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 1);
+
+  encv = box_start (ba, "encv");
+  put_zeroes (ba, 6);
+  put_uint16 (ba, 1);
+  put_zeroes (ba, 16);
+  put_uint16 (ba, 320);
+  put_uint16 (ba, 240);
+  put_uint32 (ba, 0x00480000);
+  put_uint32 (ba, 0x00480000);
+  put_uint32 (ba, 0);
+  put_uint16 (ba, 1);
+  put_zeroes (ba, 32);
+  put_uint16 (ba, 0x0018);
+  put_uint16 (ba, 0xffff);
+
+  sinf = box_start (ba, "sinf");
+  box = box_start (ba, "frma");
+  put_fourcc (ba, "jpeg");
+  box_end (ba, box);
+  box = box_start (ba, "schm");
+  put_uint32 (ba, 0);
+  put_fourcc (ba, "cenc");
+  put_uint32 (ba, 0x00010000);
+  box_end (ba, box);
+  schi = box_start (ba, "schi");
+  box = box_start (ba, "tenc");
+  put_uint32 (ba, 0);
+  put_zeroes (ba, 2);
+  put_uint8 (ba, 1);
+  put_uint8 (ba, CENC_IV_SIZE);
+  g_byte_array_append (ba, cenc_kid, sizeof (cenc_kid));
+  box_end (ba, box);
+  box_end (ba, schi);
+  box_end (ba, sinf);
+  box_end (ba, encv);
+  box_end (ba, stsd);
+
+  box = box_start (ba, "stts");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+  box = box_start (ba, "stsc");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+  box = box_start (ba, "stsz");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+  box = box_start (ba, "stco");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+  box_end (ba, stbl);
+  box_end (ba, minf);
+  box_end (ba, mdia);
+  box_end (ba, trak);
+
+  mvex = box_start (ba, "mvex");
+  box = box_start (ba, "trex");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 1);
+  put_uint32 (ba, 1);
+  put_zeroes (ba, 12);
+  box_end (ba, box);
+  box_end (ba, mvex);
+  box_end (ba, moov);
+
+  moof = box_start (ba, "moof");
+  box = box_start (ba, "mfhd");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 1);
+  box_end (ba, box);
+
+  traf = box_start (ba, "traf");
+  /* default-base-is-moof, default duration and size */
+  box = box_start (ba, "tfhd");
+  put_uint32 (ba, 0x00020018);
+  put_uint32 (ba, 1);
+  put_uint32 (ba, 1);
+  put_uint32 (ba, CENC_SAMPLE_SIZE);
+  box_end (ba, box);
+
+  box = box_start (ba, "tfdt");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+
+  box = box_start (ba, "trun");
+  put_uint32 (ba, 0x00000001);
+  put_uint32 (ba, CENC_N_SAMPLES);
+  trun_data_offset = ba->len;
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+
+  box = box_start (ba, "saiz");
+  put_uint32 (ba, 0);
+  put_uint8 (ba, 0);
+  put_uint32 (ba, CENC_N_SAMPLES);
+  for (i = 0; i < CENC_N_SAMPLES; i++) {
+    if (cenc_n_subsamples[i] > 0)
+      put_uint8 (ba, CENC_IV_SIZE + 2 + 6 * cenc_n_subsamples[i]);
+    else
+      put_uint8 (ba, CENC_IV_SIZE);
+  }
+  box_end (ba, box);
+
+  box = box_start (ba, "saio");
+  put_uint32 (ba, 0);
+  put_uint32 (ba, 1);
+  saio_offset = ba->len;
+  put_uint32 (ba, 0);
+  box_end (ba, box);
+
+  box = box_start (ba, "senc");
+  put_uint32 (ba, 0x00000002);
+  put_uint32 (ba, CENC_N_SAMPLES);
+  senc_data = ba->len;
+  for (i = 0; i < CENC_N_SAMPLES; i++) {
+    put_cenc_sample_iv (ba, i);
+    if (cenc_n_subsamples[i] > 0) {
+      put_uint16 (ba, cenc_n_subsamples[i]);
+      put_cenc_subsamples (ba, i);
+    }
+  }
+  box_end (ba, box);
+  box_end (ba, traf);
+  box_end (ba, moof);
+
+  mdat = box_start (ba, "mdat");
+  for (i = 0; i < CENC_N_SAMPLES; i++) {
+    guint8 sample[CENC_SAMPLE_SIZE];
+
+    memset (sample, i, sizeof (sample));
+    g_byte_array_append (ba, sample, sizeof (sample));
+  }
+  box_end (ba, mdat);
+
+  /* offsets relative to the moof */
+  GST_WRITE_UINT32_BE (ba->data + saio_offset, senc_data - moof);
+  GST_WRITE_UINT32_BE (ba->data + trun_data_offset, mdat + 8 - moof);
+
+  return g_byte_array_free_to_bytes (ba);
+}
+
+static void
+check_cenc_buffer (GstBuffer * buf, guint sample)
+{
+  GstProtectionMeta *meta;
+  GByteArray *expected = g_byte_array_new ();
+  const GValue *value;
+  GstBuffer *field;
+  guint count, iv_size;
+
+  meta = gst_buffer_get_protection_meta (buf);
+  fail_unless (meta != NULL);
+
+  fail_unless (gst_structure_get_uint (meta->info, "iv_size", &iv_size));
+  fail_unless_equals_int (iv_size, CENC_IV_SIZE);
+
+  value = gst_structure_get_value (meta->info, "kid");
+  fail_unless (value != NULL);
+  field = gst_value_get_buffer (value);
+  fail_unless (gst_buffer_memcmp (field, 0, cenc_kid, sizeof (cenc_kid)) == 0);
+  fail_unless_equals_int (gst_buffer_get_size (field), sizeof (cenc_kid));
+
+  put_cenc_sample_iv (expected, sample);
+  value = gst_structure_get_value (meta->info, "iv");
+  fail_unless (value != NULL);
+  field = gst_value_get_buffer (value);
+  fail_unless_equals_int (gst_buffer_get_size (field), expected->len);
+  fail_unless (gst_buffer_memcmp (field, 0, expected->data,
+          expected->len) == 0);
+
+  fail_unless (gst_structure_get_uint (meta->info, "subsample_count",
+          &count));
+  fail_unless_equals_int (count, cenc_n_subsamples[sample]);
+
+  value = gst_structure_get_value (meta->info, "subsamples");
+  if (count > 0) {
+    g_byte_array_set_size (expected, 0);
+    put_cenc_subsamples (expected, sample);
+    fail_unless (value != NULL);
+    field = gst_value_get_buffer (value);
+    fail_unless_equals_int (gst_buffer_get_size (field), expected->len);
+    fail_unless (gst_buffer_memcmp (field, 0, expected->data,
+            expected->len) == 0);
+  } else {
+    fail_unless (value == NULL);
+  }
+
+  g_byte_array_unref (expected);
+}
+
+static GstPadProbeReturn
+qtdemux_cenc_probe (GstPad * pad, GstPadProbeInfo * info, GQueue * buffers)
+{
+  if (GST_IS_BUFFER (GST_PAD_PROBE_INFO_DATA (info)))
+    g_queue_push_tail (buffers,
+        gst_buffer_ref (GST_PAD_PROBE_INFO_BUFFER (info)));
+
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+qtdemux_cenc_pad_added_cb (GstElement * element, GstPad * pad,
+    GQueue * buffers)
+{
+  GstCaps *caps = gst_pad_get_current_caps (pad);
+
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "application/x-cenc"));
+  gst_caps_unref (caps);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_DATA_DOWNSTREAM,
+      (GstPadProbeCallback) qtdemux_cenc_probe, buffers, NULL);
+}
+
+GST_START_TEST (test_qtdemux_cenc_protection_meta)
+{
+  GstElement *qtdemux;
+  GstPad *sinkpad;
+  GQueue buffers = G_QUEUE_INIT;
+  GstBuffer *inbuf;
+  GstSegment segment;
+  GBytes *stream;
+  guint i;
+
+  qtdemux = gst_element_factory_make ("qtdemux", NULL);
+  gst_element_set_state (qtdemux, GST_STATE_PLAYING);
+  sinkpad = gst_element_get_static_pad (qtdemux, "sink");
+  g_signal_connect (qtdemux, "pad-added",
+      (GCallback) qtdemux_cenc_pad_added_cb, &buffers);
+
+  fail_unless (gst_pad_send_event (sinkpad,
+          gst_event_new_stream_start ("TEST")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_send_event (sinkpad, gst_event_new_segment (&segment)));
+
+  stream = create_cenc_fragmented_stream ();
+  inbuf = gst_buffer_new_wrapped_bytes (stream);
+  GST_BUFFER_PTS (inbuf) = 0;
+  GST_BUFFER_OFFSET (inbuf) = 0;
+  fail_unless_equals_int (gst_pad_chain (sinkpad, inbuf), GST_FLOW_OK);
+  g_bytes_unref (stream);
+
+  /* every sample carries its own IV and subsamples */
+  fail_unless_equals_int (g_queue_get_length (&buffers), CENC_N_SAMPLES);
+  for (i = 0; i < CENC_N_SAMPLES; i++) {
+    GstBuffer *buf = g_queue_pop_head (&buffers);
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), CENC_SAMPLE_SIZE);
+    check_cenc_buffer (buf, i);
+    gst_buffer_unref (buf);
+  }
+
+  gst_object_unref (sinkpad);
+  gst_element_set_state (qtdemux, GST_STATE_NULL);
+  gst_object_unref (qtdemux);
+}
+
+GST_END_TEST;
+
 static Suite *
 qtdemux_suite (void)
 {
@@ -901,6 +1347,7 @@ qtdemux_suite (void)
   tcase_add_test (tc_chain, test_qtdemux_duplicated_moov);
   tcase_add_test (tc_chain, test_qtdemux_stream_change);
   tcase_add_test (tc_chain, test_qtdemux_pad_names);
+  tcase_add_test (tc_chain, test_qtdemux_cenc_protection_meta);
 
   return s;
 }
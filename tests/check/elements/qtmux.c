@@ -1431,7 +1431,8 @@ check_output (const gchar * location, struct TestInputData *input1,
  * then verifies that the generated file corresponds to the
  * data in the inputs */
 static void
-run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
+run_muxing_test_full (struct TestInputData *input1,
+    struct TestInputData *input2, gboolean faststart)
 {
   gchar *location;
   GstElement *qtmux;
@@ -1441,6 +1442,7 @@ run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
   location = g_strdup_printf ("%s/%s-%d", g_get_tmp_dir (), "qtmuxtest",
       g_random_int ());
   qtmux = gst_check_setup_element ("qtmux");
+  g_object_set (qtmux, "faststart", faststart, NULL);
   filesink = gst_element_factory_make ("filesink", NULL);
   g_object_set (filesink, "location", location, NULL);
   gst_element_link (qtmux, filesink);
@@ -1494,7 +1496,14 @@ run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
   g_free (location);
 }
 
-GST_START_TEST (test_muxing)
+static void
+run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
+{
+  run_muxing_test_full (input1, input2, FALSE);
+}
+
+static void
+test_muxing_common (gboolean faststart)
 {
   struct TestInputData input1, input2;
   GstCaps *caps;
@@ -1545,7 +1554,21 @@ GST_START_TEST (test_muxing)
           2 * GST_SECOND, GST_SECOND, 4096));
   input2.input = g_list_append (input2.input, gst_event_new_eos ());
 
-  run_muxing_test (&input1, &input2);
+  run_muxing_test_full (&input1, &input2, faststart);
+}
+
+GST_START_TEST (test_muxing)
+{
+  test_muxing_common (FALSE);
+}
+
+GST_END_TEST;
+
+/* the buffered mdat is larger than the block size used to replay the
+ * temporary file, so this goes through more than one block */
+GST_START_TEST (test_muxing_faststart)
+{
+  test_muxing_common (TRUE);
 }
 
 GST_END_TEST;
@@ -1894,6 +1917,7 @@ qtmux_suite (void)
   tcase_add_test (tc_chain, test_encodebin_mp4mux);
 
   tcase_add_test (tc_chain, test_muxing);
+  tcase_add_test (tc_chain, test_muxing_faststart);
   tcase_add_test (tc_chain, test_muxing_non_zero_segment);
   tcase_add_test (tc_chain, test_muxing_non_zero_segment_different);
   tcase_add_test (tc_chain, test_muxing_dts_outside_segment);
@@ -1198,6 +1198,244 @@ GST_START_TEST (rtp_L24)
       "rtpL24pay", "rtpL24depay", 0, 0, FALSE);
 }
 
+GST_END_TEST;
+
+static GstBuffer *
+create_rtp_L16_buffer (guint16 seq, guint32 rtptime, guint samples)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+
+  buf = gst_rtp_buffer_new_allocate (samples * 2, 0, 0);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, rtptime);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_BUFFER_PTS (buf) = gst_util_uint64_scale_int (rtptime, GST_SECOND,
+      48000);
+
+  return buf;
+}
+
+static void
+pull_and_check_L16_buffer (GstHarness * h, GstClockTime pts, guint samples)
+{
+  GstBuffer *buf;
+
+  buf = gst_harness_pull (h);
+  fail_unless (buf != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buf), samples * 2);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), pts);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf),
+      gst_util_uint64_scale_int (samples, GST_SECOND, 48000));
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (rtp_L16_depay_aggregate)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstSegment segment;
+  guint i;
+
+  h = gst_harness_new_parse ("rtpL16depay aggregate-time=10000000");
+  gst_harness_set_src_caps_str (h, "application/x-rtp, media=audio, "
+      "clock-rate=48000, encoding-name=L16, encoding-params=(string)1, "
+      "payload=96");
+
+  /* 1ms packets are collected into 10ms buffers */
+  for (i = 0; i < 25; i++) {
+    fail_unless_equals_int (gst_harness_push (h,
+            create_rtp_L16_buffer (i, i * 48, 48)), GST_FLOW_OK);
+  }
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+  pull_and_check_L16_buffer (h, 0, 480);
+  pull_and_check_L16_buffer (h, 10 * GST_MSECOND, 480);
+
+  /* a timestamp gap pushes out the pending 5ms right away */
+  fail_unless_equals_int (gst_harness_push (h,
+          create_rtp_L16_buffer (25, 26 * 48, 48)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  pull_and_check_L16_buffer (h, 20 * GST_MSECOND, 240);
+
+  /* so does a lost packet, the data after it keeps the DISCONT flag */
+  fail_unless_equals_int (gst_harness_push (h,
+          create_rtp_L16_buffer (27, 28 * 48, 48)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  pull_and_check_L16_buffer (h, 26 * GST_MSECOND, 48);
+
+  /* a new segment drains the pending data before it */
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_harness_push_event (h, gst_event_new_segment (&segment)));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  buf = gst_harness_pull (h);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), 28 * GST_MSECOND);
+  fail_unless (GST_BUFFER_IS_DISCONT (buf));
+  gst_buffer_unref (buf);
+
+  /* and EOS drains the rest */
+  fail_unless_equals_int (gst_harness_push (h,
+          create_rtp_L16_buffer (28, 29 * 48, 48)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 0);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  pull_and_check_L16_buffer (h, 29 * GST_MSECOND, 48);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static void
+pull_and_check_L16_packet (GstHarness * h, guint32 rtptime, guint samples,
+    gboolean marker)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+
+  buf = gst_harness_pull (h);
+  fail_unless (buf != NULL);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), samples * 2);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), rtptime);
+  fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp), marker);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (rtp_L16_pay_packet_list)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint i;
+
+  h = gst_harness_new_parse ("rtpL16pay packet-list=true max-ptime=1000000 "
+      "timestamp-offset=0");
+  gst_harness_set_src_caps_str (h, "audio/x-raw, format=S16BE, "
+      "layout=interleaved, rate=48000, channels=1");
+
+  /* 10ms are cut into ten 1ms packets */
+  buf = gst_harness_create_buffer (h, 480 * 2);
+  GST_BUFFER_PTS (buf) = 0;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 10);
+  for (i = 0; i < 10; i++)
+    pull_and_check_L16_packet (h, i * 48, 48, i == 0);
+
+  /* the remainder of a buffer is completed by the next one */
+  buf = gst_harness_create_buffer (h, 120 * 2);
+  GST_BUFFER_PTS (buf) = 10 * GST_MSECOND;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+  buf = gst_harness_create_buffer (h, 24 * 2);
+  GST_BUFFER_PTS (buf) = 12500 * GST_USECOND;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 3);
+  for (i = 10; i < 13; i++)
+    pull_and_check_L16_packet (h, i * 48, 48, FALSE);
+
+  /* and whatever is left is pushed on EOS */
+  buf = gst_harness_create_buffer (h, 12 * 2);
+  GST_BUFFER_PTS (buf) = 13 * GST_MSECOND;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 0);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  pull_and_check_L16_packet (h, 13 * 48, 12, FALSE);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtp_L16_pay_packet_list_shrink)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+
+  h = gst_harness_new_parse ("rtpL16pay packet-list=true max-ptime=1000000 "
+      "timestamp-offset=0");
+  gst_harness_set_src_caps_str (h, "audio/x-raw, format=S16BE, "
+      "layout=interleaved, rate=48000, channels=1");
+
+  buf = gst_harness_create_buffer (h, 40 * 2);
+  GST_BUFFER_PTS (buf) = 0;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 0);
+
+  /* with smaller packets the pending samples fill one on their own, and the
+   * rest is completed by the next buffer */
+  g_object_set (h->element, "max-ptime", (gint64) 500000, NULL);
+  buf = gst_harness_create_buffer (h, 10 * 2);
+  GST_BUFFER_PTS (buf) = 40 * GST_SECOND / 48000;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+  pull_and_check_L16_packet (h, 0, 24, TRUE);
+  pull_and_check_L16_packet (h, 24, 24, FALSE);
+
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  pull_and_check_L16_packet (h, 48, 2, FALSE);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtp_stream_pay_depay_list)
+{
+  GstHarness *pay, *depay;
+  GstBufferList *list;
+  GstBuffer *buf, *stream;
+  GstMapInfo map;
+  guint i;
+
+  pay = gst_harness_new ("rtpstreampay");
+  gst_harness_set_src_caps_str (pay, "application/x-rtp, media=audio, "
+      "clock-rate=8000, encoding-name=PCMU, payload=0");
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, gst_rtp_buffer_new_allocate (10 + i, 0, 0));
+  fail_unless_equals_int (gst_pad_push_list (pay->srcpad, list), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (pay), 3);
+
+  /* glue all framed packets together and feed them to the depayloader in
+   * chunks that don't line up with the packet boundaries */
+  stream = gst_buffer_new ();
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_pull (pay);
+    fail_unless_equals_int (gst_buffer_get_size (buf), 2 + 12 + 10 + i);
+    fail_unless (gst_buffer_map (buf, GST_MAP_READ, &map));
+    fail_unless_equals_int (GST_READ_UINT16_BE (map.data), 12 + 10 + i);
+    gst_buffer_unmap (buf, &map);
+    stream = gst_buffer_append (stream, buf);
+  }
+
+  depay = gst_harness_new ("rtpstreamdepay");
+  gst_harness_set_src_caps_str (depay, "application/x-rtp-stream, "
+      "media=audio, clock-rate=8000, encoding-name=PCMU, payload=0");
+
+  buf = gst_buffer_copy_region (stream, GST_BUFFER_COPY_ALL, 0, 30);
+  fail_unless_equals_int (gst_harness_push (depay, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (depay), 1);
+  buf = gst_buffer_copy_region (stream, GST_BUFFER_COPY_ALL, 30, -1);
+  fail_unless_equals_int (gst_harness_push (depay, buf), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (depay), 3);
+
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_pull (depay);
+    fail_unless_equals_int (gst_buffer_get_size (buf), 12 + 10 + i);
+    gst_buffer_unref (buf);
+  }
+
+  gst_buffer_unref (stream);
+  gst_harness_teardown (pay);
+  gst_harness_teardown (depay);
+}
+
 GST_END_TEST;
 static const guint8 rtp_mp2t_frame_data[] =
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -1803,6 +2041,10 @@ rtp_payloading_suite (void)
   tcase_add_test (tc_chain, rtp_klv_fragmented);
   tcase_add_test (tc_chain, rtp_L16);
   tcase_add_test (tc_chain, rtp_L24);
+  tcase_add_test (tc_chain, rtp_L16_depay_aggregate);
+  tcase_add_test (tc_chain, rtp_L16_pay_packet_list);
+  tcase_add_test (tc_chain, rtp_L16_pay_packet_list_shrink);
+  tcase_add_test (tc_chain, rtp_stream_pay_depay_list);
   tcase_add_test (tc_chain, rtp_mp2t);
   tcase_add_test (tc_chain, rtp_mp4v);
   tcase_add_test (tc_chain, rtp_mp4v_list);
@@ -488,6 +488,65 @@ GST_START_TEST (rtpfunnel_twcc_passthrough_then_mux)
 
 GST_END_TEST;
 
+GST_START_TEST (rtpfunnel_twcc_shared_buffer_and_list)
+{
+  GstHarness *h, *h0, *h1;
+  GstBufferList *list;
+  GstBuffer *buf, *orig;
+  GstMemory *payload;
+  GstMapInfo map, orig_map;
+  guint i;
+
+  h = gst_harness_new_with_padnames ("rtpfunnel", NULL, "src");
+  h0 = gst_harness_new_with_element (h->element, "sink_0", NULL);
+  h1 = gst_harness_new_with_element (h->element, "sink_1", NULL);
+  gst_harness_set_src_caps_str (h0, "application/x-rtp, "
+      "ssrc=(uint)123, extmap-5=" TWCC_EXTMAP_STR "");
+  gst_harness_set_src_caps_str (h1, "application/x-rtp, "
+      "ssrc=(uint)456, extmap-5=" TWCC_EXTMAP_STR "");
+
+  /* a packet that is also held elsewhere, with its payload in a separate
+   * memory like payloaders produce */
+  orig = generate_test_buffer (500, 123, 5);
+  payload = gst_allocator_alloc (NULL, 100, NULL);
+  gst_buffer_append_memory (orig, payload);
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h0, gst_buffer_ref (orig)));
+
+  buf = gst_harness_pull (h);
+  fail_unless_equals_int (0, get_twcc_seqnum (buf, 5));
+  /* the original is untouched and the payload was not copied */
+  fail_unless_equals_int (500, get_twcc_seqnum (orig, 5));
+  fail_unless (gst_memory_map (gst_buffer_peek_memory (buf,
+              gst_buffer_n_memory (buf) - 1), &map, GST_MAP_READ));
+  fail_unless (gst_memory_map (payload, &orig_map, GST_MAP_READ));
+  fail_unless (map.data == orig_map.data);
+  gst_memory_unmap (payload, &orig_map);
+  gst_memory_unmap (gst_buffer_peek_memory (buf,
+          gst_buffer_n_memory (buf) - 1), &map);
+  gst_buffer_unref (buf);
+  gst_buffer_unref (orig);
+
+  /* buffer lists get stamped too */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, generate_test_buffer (60000 + i, 456, 5));
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h1->srcpad, list));
+
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (456, get_ssrc (buf));
+    fail_unless_equals_int (i + 1, get_twcc_seqnum (buf, 5));
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h1);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpfunnel_suite (void)
 {
@@ -507,6 +566,7 @@ rtpfunnel_suite (void)
   tcase_add_test (tc_chain, rtpfunnel_twcc_passthrough);
   tcase_add_test (tc_chain, rtpfunnel_twcc_mux);
   tcase_add_test (tc_chain, rtpfunnel_twcc_passthrough_then_mux);
+  tcase_add_test (tc_chain, rtpfunnel_twcc_shared_buffer_and_list);
 
   return s;
 }
@@ -164,7 +164,7 @@ session_harness_get_last_twcc_stats (SessionHarness * h)
 }
 
 static SessionHarness *
-session_harness_new (void)
+session_harness_new_full (gboolean shared_rtcp_scheduler)
 {
   SessionHarness *h = g_new0 (SessionHarness, 1);
   h->caps = generate_caps ();
@@ -174,6 +174,8 @@ session_harness_new (void)
   gst_system_clock_set_default (GST_CLOCK_CAST (h->testclock));
 
   h->session = gst_element_factory_make ("rtpsession", NULL);
+  g_object_set (h->session, "shared-rtcp-scheduler", shared_rtcp_scheduler,
+      NULL);
   gst_element_set_clock (h->session, GST_CLOCK_CAST (h->testclock));
 
   h->send_rtp_h = gst_harness_new_with_element (h->session,
@@ -199,6 +201,12 @@ session_harness_new (void)
   return h;
 }
 
+static SessionHarness *
+session_harness_new (void)
+{
+  return session_harness_new_full (FALSE);
+}
+
 static void
 session_harness_free (SessionHarness * h)
 {
@@ -352,6 +360,40 @@ session_harness_set_twcc_send_ext_id (SessionHarness * h, guint8 ext_id)
   gst_harness_set_src_caps (h->send_rtp_h, caps);
 }
 
+GST_START_TEST (test_shared_rtcp_scheduler)
+{
+  SessionHarness *h = session_harness_new_full (TRUE);
+  GstBuffer *buf;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket rtcp_packet;
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0xDEADBEEF)));
+  }
+
+  /* the timeout is scheduled asynchronously on the clock, crank it and
+   * check that the shared scheduler produced a RR and rescheduled */
+  for (i = 0; i < 2; i++) {
+    session_harness_produce_rtcp (h, 1);
+    buf = session_harness_pull_rtcp (h);
+
+    fail_unless (gst_rtcp_buffer_validate (buf));
+    gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+    fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet));
+    fail_unless_equals_int (GST_RTCP_TYPE_RR,
+        gst_rtcp_packet_get_type (&rtcp_packet));
+    fail_unless_equals_int (1, gst_rtcp_packet_get_rb_count (&rtcp_packet));
+    gst_rtcp_buffer_unmap (&rtcp);
+    gst_buffer_unref (buf);
+  }
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_multiple_ssrc_rr)
 {
   SessionHarness *h = session_harness_new ();
@@ -3626,6 +3668,57 @@ GST_START_TEST (test_twcc_no_exthdr_in_buffer)
 GST_END_TEST;
 
 
+GST_START_TEST (test_twcc_twobyte_exthdr)
+{
+  SessionHarness *h = session_harness_new ();
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  guint8 *fci_data;
+  GstBuffer *buf;
+  guint i;
+
+  session_harness_set_twcc_recv_ext_id (h, TEST_TWCC_EXT_ID);
+
+  /* TWCC seqnum in a two-byte header, after an element of the largest
+   * possible size */
+  for (i = 0; i < 5; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    guint8 other[255] = { 0, };
+    guint8 twcc_seqnum_be[2];
+
+    buf = generate_test_buffer (i, TEST_BUF_SSRC);
+    gst_rtp_buffer_map (buf, GST_MAP_READWRITE, &rtp);
+    gst_rtp_buffer_set_marker (&rtp, i == 4);
+    fail_unless (gst_rtp_buffer_add_extension_twobytes_header (&rtp, 0, 1,
+            other, sizeof (other)));
+    GST_WRITE_UINT16_BE (twcc_seqnum_be, 100 + i);
+    fail_unless (gst_rtp_buffer_add_extension_twobytes_header (&rtp, 0,
+            TEST_TWCC_EXT_ID, twcc_seqnum_be, sizeof (twcc_seqnum_be)));
+    gst_rtp_buffer_unmap (&rtp);
+
+    fail_unless_equals_int (GST_FLOW_OK, session_harness_recv_rtp (h, buf));
+  }
+
+  session_harness_produce_rtcp (h, 1);
+  buf = session_harness_pull_twcc_rtcp (h);
+  fail_unless (buf);
+
+  gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &packet));
+  fci_data = gst_rtcp_packet_fb_get_fci (&packet);
+
+  /* base seqnum and packet count */
+  fail_unless_equals_int (100, GST_READ_UINT16_BE (&fci_data[0]));
+  fail_unless_equals_int (5, GST_READ_UINT16_BE (&fci_data[2]));
+
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_twcc_send_and_recv)
 {
   SessionHarness *h_send = session_harness_new ();
@@ -3705,6 +3798,7 @@ rtpsession_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_multiple_ssrc_rr);
+  tcase_add_test (tc_chain, test_shared_rtcp_scheduler);
   tcase_add_test (tc_chain, test_multiple_senders_roundrobin_rbs);
   tcase_add_test (tc_chain, test_no_rbs_for_internal_senders);
   tcase_add_test (tc_chain, test_internal_sources_timeout);
@@ -3760,6 +3854,7 @@ rtpsession_suite (void)
   tcase_add_test (tc_chain, test_twcc_recv_packets_reordered);
   tcase_add_test (tc_chain, test_twcc_recv_rtcp_reordered);
   tcase_add_test (tc_chain, test_twcc_no_exthdr_in_buffer);
+  tcase_add_test (tc_chain, test_twcc_twobyte_exthdr);
   tcase_add_test (tc_chain, test_twcc_send_and_recv);
 
   return s;
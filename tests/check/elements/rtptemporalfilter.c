@@ -0,0 +1,242 @@
+/* GStreamer
+ *
+ * Copyright (C) <2021> The GStreamer project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/check.h>
+#include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define RTP_VP8_CAPS_STR \
+  "application/x-rtp,media=video,encoding-name=VP8,clock-rate=90000,payload=96"
+#define RTP_H264_CAPS_STR \
+  "application/x-rtp,media=video,encoding-name=H264,clock-rate=90000,payload=96"
+
+#define FRAME_MARKING_EXT_ID 3
+
+/* One packet per frame with a 15 bit picture ID and the T bit set */
+static GstBuffer *
+create_vp8_packet (guint16 seqnum, guint16 picture_id, guint tid,
+    gboolean sync, gboolean keyframe)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+  guint8 *payload;
+
+  buf = gst_rtp_buffer_new_allocate (10, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, seqnum * 3000);
+  gst_rtp_buffer_set_marker (&rtp, TRUE);
+
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  memset (payload, 0, 10);
+  /* X and S bits, partition 0 */
+  payload[0] = 0x90;
+  /* I and T bits */
+  payload[1] = 0xa0;
+  GST_WRITE_UINT16_BE (&payload[2], 0x8000 | picture_id);
+  payload[4] = (tid << 6) | (sync ? 0x20 : 0x00);
+  /* VP8 payload header, inverse key frame flag */
+  payload[5] = keyframe ? 0x00 : 0x01;
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static GstBuffer *
+create_frame_marking_packet (guint16 seqnum, gboolean start, guint tid,
+    gboolean sync)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+  guint8 fm[3];
+
+  buf = gst_rtp_buffer_new_allocate (10, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, (seqnum / 2) * 3000);
+  gst_rtp_buffer_set_marker (&rtp, !start);
+  memset (gst_rtp_buffer_get_payload (&rtp), 0, 10);
+
+  fm[0] = (start ? 0x80 : 0x40) | (sync ? 0x08 : 0x00) | tid;
+  fm[1] = 0;
+  fm[2] = 0;
+  fail_unless (gst_rtp_buffer_add_extension_onebyte_header (&rtp,
+          FRAME_MARKING_EXT_ID, fm, sizeof (fm)));
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static void
+pull_and_check_vp8_packet (GstHarness * h, guint16 seqnum,
+    guint16 picture_id, guint tid)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+  guint8 *payload;
+
+  buf = gst_harness_pull (h);
+  fail_unless (buf);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  fail_unless_equals_int (GST_READ_UINT16_BE (&payload[2]),
+      0x8000 | picture_id);
+  fail_unless_equals_int (payload[4] >> 6, tid);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+static void
+pull_and_check_seqnum (GstHarness * h, guint16 seqnum)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+
+  buf = gst_harness_pull (h);
+  fail_unless (buf);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+/* temporal layer pattern of a three layer stream */
+static const guint l1t3_tids[] = { 0, 2, 1, 2 };
+
+GST_START_TEST (test_rtptemporalfilter_vp8_base_layer)
+{
+  GstHarness *h = gst_harness_new ("rtptemporalfilter");
+  guint dropped;
+  guint i;
+
+  g_object_set (h->element, "max-temporal-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, RTP_VP8_CAPS_STR);
+
+  for (i = 0; i < 8; i++) {
+    guint tid = l1t3_tids[i % 4];
+
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h,
+            create_vp8_packet (1000 + i, 100 + i, tid, TRUE, i == 0)));
+  }
+
+  /* only the base layer, with continuous seqnums and picture IDs */
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+  pull_and_check_vp8_packet (h, 1000, 100, 0);
+  pull_and_check_vp8_packet (h, 1001, 101, 0);
+
+  g_object_get (h->element, "dropped", &dropped, NULL);
+  fail_unless_equals_int (dropped, 6);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtptemporalfilter_vp8_switch_up)
+{
+  GstHarness *h = gst_harness_new ("rtptemporalfilter");
+  guint16 seq = 0;
+
+  g_object_set (h->element, "max-temporal-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, RTP_VP8_CAPS_STR);
+
+  gst_harness_push (h, create_vp8_packet (seq, seq, 0, TRUE, TRUE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 2, FALSE, FALSE));
+  seq++;
+
+  g_object_set (h->element, "max-temporal-layer", 2, NULL);
+
+  /* can't switch up without a layer sync point */
+  gst_harness_push (h, create_vp8_packet (seq, seq, 1, FALSE, FALSE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 2, FALSE, FALSE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 0, TRUE, FALSE));
+  seq++;
+  /* layers are added one at a time */
+  gst_harness_push (h, create_vp8_packet (seq, seq, 2, TRUE, FALSE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 1, TRUE, FALSE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 2, TRUE, FALSE));
+  seq++;
+  gst_harness_push (h, create_vp8_packet (seq, seq, 0, TRUE, FALSE));
+  seq++;
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 5);
+  pull_and_check_vp8_packet (h, 0, 0, 0);
+  pull_and_check_vp8_packet (h, 1, 1, 0);
+  pull_and_check_vp8_packet (h, 2, 2, 1);
+  pull_and_check_vp8_packet (h, 3, 3, 2);
+  pull_and_check_vp8_packet (h, 4, 4, 0);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtptemporalfilter_frame_marking)
+{
+  GstHarness *h = gst_harness_new ("rtptemporalfilter");
+  guint i;
+
+  g_object_set (h->element, "max-temporal-layer", 0,
+      "frame-marking-ext-id", FRAME_MARKING_EXT_ID, NULL);
+  gst_harness_set_src_caps_str (h, RTP_H264_CAPS_STR);
+
+  /* two packets per frame, alternating between layer 0 and 1 */
+  for (i = 0; i < 8; i++) {
+    guint tid = (i / 2) % 2;
+
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h,
+            create_frame_marking_packet (65534 + i, i % 2 == 0, tid, TRUE)));
+  }
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 4);
+  for (i = 0; i < 4; i++)
+    pull_and_check_seqnum (h, (guint16) (65534 + i));
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtptemporalfilter_suite (void)
+{
+  Suite *s = suite_create ("rtptemporalfilter");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_rtptemporalfilter_vp8_base_layer);
+  tcase_add_test (tc_chain, test_rtptemporalfilter_vp8_switch_up);
+  tcase_add_test (tc_chain, test_rtptemporalfilter_frame_marking);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtptemporalfilter);
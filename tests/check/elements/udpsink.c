@@ -19,6 +19,7 @@
  */
 #include <gst/check/gstcheck.h>
 #include <gst/base/gstbasesink.h>
+#include <gst/net/gstnetaddressmeta.h>
 #include <gio/gio.h>
 #include <stdlib.h>
 
@@ -205,6 +206,278 @@ GST_START_TEST (test_udpsink_client_add_remove)
 
 GST_END_TEST;
 
+/* with this many buffers in a list, a shard holds 16 clients */
+#define MANY_CLIENTS_NUM_BUFFERS 64
+#define MANY_CLIENTS_PACKET_SIZE 16
+#define MANY_CLIENTS_PER_FAMILY 24
+
+/* binds a socket to a free port on the loopback address of @family */
+static GSocket *
+create_receiver_socket (GSocketFamily family, guint16 * port)
+{
+  GSocket *socket;
+  GInetAddress *addr;
+  GSocketAddress *saddr, *bound_addr;
+  gboolean bound;
+
+  socket = g_socket_new (family, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  if (socket == NULL)
+    return NULL;
+
+  addr = g_inet_address_new_loopback (family);
+  saddr = g_inet_socket_address_new (addr, 0);
+  bound = g_socket_bind (socket, saddr, FALSE, NULL);
+  g_object_unref (saddr);
+  g_object_unref (addr);
+
+  if (!bound) {
+    g_object_unref (socket);
+    return NULL;
+  }
+
+  bound_addr = g_socket_get_local_address (socket, NULL);
+  *port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound_addr));
+  g_object_unref (bound_addr);
+  g_socket_set_blocking (socket, FALSE);
+
+  return socket;
+}
+
+/* checks that @socket got @n_times all the packets of the list, in order */
+static void
+check_received_packets (GSocket * socket, guint n_times)
+{
+  guint8 data[MANY_CLIENTS_PACKET_SIZE + 1];
+  gssize len;
+  guint n = 0;
+
+  while ((len = g_socket_receive (socket, (gchar *) data, sizeof (data),
+              NULL, NULL)) >= 0) {
+    fail_unless_equals_int (len, MANY_CLIENTS_PACKET_SIZE);
+    fail_unless_equals_int (GST_READ_UINT32_BE (data),
+        n % MANY_CLIENTS_NUM_BUFFERS);
+    n++;
+  }
+  fail_unless_equals_int (n, n_times * MANY_CLIENTS_NUM_BUFFERS);
+}
+
+static void
+check_client_bytes_sent (GstElement * sink, const gchar * host, guint16 port,
+    guint64 expected)
+{
+  GstStructure *stats = NULL;
+  guint64 bytes_sent = 0;
+
+  g_signal_emit_by_name (sink, "get-stats", host, (gint) port, &stats);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-sent", &bytes_sent));
+  fail_unless_equals_uint64 (bytes_sent, expected);
+  gst_structure_free (stats);
+}
+
+GST_START_TEST (test_multiudpsink_many_clients)
+{
+  GSocket *sockets_v4[MANY_CLIENTS_PER_FAMILY] = { NULL, };
+  GSocket *sockets_v6[MANY_CLIENTS_PER_FAMILY] = { NULL, };
+  guint16 ports_v4[MANY_CLIENTS_PER_FAMILY], ports_v6[MANY_CLIENTS_PER_FAMILY];
+  gboolean have_ipv6 = TRUE;
+  GstElement *sink;
+  GstPad *srcpad;
+  GstSegment segment;
+  GstBufferList *list;
+  guint i;
+
+  for (i = 0; i < MANY_CLIENTS_PER_FAMILY; i++) {
+    sockets_v4[i] = create_receiver_socket (G_SOCKET_FAMILY_IPV4,
+        &ports_v4[i]);
+    fail_unless (sockets_v4[i] != NULL);
+
+    if (have_ipv6) {
+      sockets_v6[i] = create_receiver_socket (G_SOCKET_FAMILY_IPV6,
+          &ports_v6[i]);
+      have_ipv6 = sockets_v6[i] != NULL;
+    }
+  }
+  if (!have_ipv6)
+    GST_INFO ("no IPv6 loopback, only testing IPv4 clients");
+
+  sink = gst_check_setup_element ("multiudpsink");
+
+  /* add the IPv4 and IPv6 clients interleaved. The sink sorts them and the
+   * shard in the middle holds clients of both families. The first client is
+   * added twice and gets everything twice */
+  for (i = 0; i < MANY_CLIENTS_PER_FAMILY; i++) {
+    g_signal_emit_by_name (sink, "add", "127.0.0.1", (gint) ports_v4[i], NULL);
+    if (have_ipv6)
+      g_signal_emit_by_name (sink, "add", "::1", (gint) ports_v6[i], NULL);
+  }
+  g_signal_emit_by_name (sink, "add", "127.0.0.1", (gint) ports_v4[0], NULL);
+
+  srcpad = gst_check_setup_src_pad_by_name (sink, &srctemplate, "sink");
+
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("hey there!"));
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* each packet carries its index in the list */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < MANY_CLIENTS_NUM_BUFFERS; i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_allocate (NULL, MANY_CLIENTS_PACKET_SIZE, NULL);
+    gst_buffer_memset (buf, 0, 0, MANY_CLIENTS_PACKET_SIZE);
+    gst_buffer_memset (buf, 3, i, 1);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  for (i = 0; i < MANY_CLIENTS_PER_FAMILY; i++) {
+    guint n_times = i == 0 ? 2 : 1;
+
+    check_received_packets (sockets_v4[i], n_times);
+    check_client_bytes_sent (sink, "127.0.0.1", ports_v4[i],
+        n_times * MANY_CLIENTS_NUM_BUFFERS * MANY_CLIENTS_PACKET_SIZE);
+
+    if (have_ipv6) {
+      check_received_packets (sockets_v6[i], 1);
+      check_client_bytes_sent (sink, "::1", ports_v6[i],
+          MANY_CLIENTS_NUM_BUFFERS * MANY_CLIENTS_PACKET_SIZE);
+    }
+  }
+
+  gst_check_teardown_pad_by_name (sink, "sink");
+  gst_check_teardown_element (sink);
+
+  for (i = 0; i < MANY_CLIENTS_PER_FAMILY; i++) {
+    g_object_unref (sockets_v4[i]);
+    if (sockets_v6[i])
+      g_object_unref (sockets_v6[i]);
+  }
+}
+
+GST_END_TEST;
+
+/* a bound loopback socket to receive on and its address */
+static GSocket *
+new_receiver_socket (GSocketAddress ** bound_addr)
+{
+  GSocket *socket;
+  GInetAddress *addr;
+  GSocketAddress *saddr;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  addr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (addr, 0);
+  fail_unless (g_socket_bind (socket, saddr, TRUE, NULL));
+  *bound_addr = g_socket_get_local_address (socket, NULL);
+  fail_unless (*bound_addr != NULL);
+  g_object_unref (saddr);
+  g_object_unref (addr);
+
+  return socket;
+}
+
+/* receives packet @i and checks that the contents of all its memories
+ * arrived in order */
+static void
+check_dynudpsink_packet (GSocket * socket, guint i)
+{
+  guint8 data[RTP_HEADER_SIZE + 2 * RTP_PAYLOAD_SIZE];
+  gssize received;
+  guint j;
+
+  received = g_socket_receive (socket, (gchar *) data, sizeof (data), NULL,
+      NULL);
+  fail_unless_equals_int (received, RTP_HEADER_SIZE + 2 * RTP_PAYLOAD_SIZE);
+
+  for (j = 0; j < RTP_HEADER_SIZE; j++)
+    fail_unless_equals_int (data[j], i);
+  for (j = 0; j < RTP_PAYLOAD_SIZE; j++) {
+    fail_unless_equals_int (data[RTP_HEADER_SIZE + j], 0x80 | i);
+    fail_unless_equals_int (data[RTP_HEADER_SIZE + RTP_PAYLOAD_SIZE + j],
+        0xc0 | i);
+  }
+}
+
+GST_START_TEST (test_dynudpsink_bufferlist)
+{
+  GstElement *sink;
+  GstPad *srcpad;
+  GstSegment segment;
+  GstBufferList *list;
+  GSocket *sockets[2];
+  GSocketAddress *addrs[2];
+  static const gint dests[] = { 0, 1, 1, 1, -1, 0 };
+  guint i;
+
+  /* the sockets the packets are sent to */
+  sockets[0] = new_receiver_socket (&addrs[0]);
+  sockets[1] = new_receiver_socket (&addrs[1]);
+
+  sink = gst_check_setup_element ("dynudpsink");
+  srcpad = gst_check_setup_src_pad_by_name (sink, &srctemplate, "sink");
+
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("hey there!"));
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* packets made of a header and two payload memories, each with a
+   * different content per packet. The destination changes between packets
+   * and also stays the same for a few, packet 4 has no address and is
+   * skipped */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (dests); i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, RTP_HEADER_SIZE, NULL);
+    GstBuffer *payload;
+
+    gst_buffer_memset (buf, 0, i, RTP_HEADER_SIZE);
+    payload = gst_buffer_new_allocate (NULL, RTP_PAYLOAD_SIZE, NULL);
+    gst_buffer_memset (payload, 0, 0x80 | i, RTP_PAYLOAD_SIZE);
+    buf = gst_buffer_append (buf, payload);
+    payload = gst_buffer_new_allocate (NULL, RTP_PAYLOAD_SIZE, NULL);
+    gst_buffer_memset (payload, 0, 0xc0 | i, RTP_PAYLOAD_SIZE);
+    buf = gst_buffer_append (buf, payload);
+    fail_unless_equals_int (gst_buffer_n_memory (buf), 3);
+
+    if (dests[i] >= 0)
+      gst_buffer_add_net_address_meta (buf, addrs[dests[i]]);
+    gst_buffer_list_add (list, buf);
+  }
+
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* every packet arrived at its own destination only, in order */
+  check_dynudpsink_packet (sockets[0], 0);
+  check_dynudpsink_packet (sockets[0], 5);
+  check_dynudpsink_packet (sockets[1], 1);
+  check_dynudpsink_packet (sockets[1], 2);
+  check_dynudpsink_packet (sockets[1], 3);
+
+  fail_if (g_socket_condition_check (sockets[0], G_IO_IN) & G_IO_IN);
+  fail_if (g_socket_condition_check (sockets[1], G_IO_IN) & G_IO_IN);
+
+  gst_check_teardown_pad_by_name (sink, "sink");
+  gst_check_teardown_element (sink);
+
+  for (i = 0; i < 2; i++) {
+    g_object_unref (addrs[i]);
+    g_object_unref (sockets[i]);
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_udpsink_dscp)
 {
   GstElement *udpsink;
@@ -251,6 +524,8 @@ udpsink_suite (void)
   tcase_add_test (tc_chain, test_udpsink_bufferlist);
   tcase_add_test (tc_chain, test_udpsink_client_add_remove);
   tcase_add_test (tc_chain, test_udpsink_dscp);
+  tcase_add_test (tc_chain, test_multiudpsink_many_clients);
+  tcase_add_test (tc_chain, test_dynudpsink_bufferlist);
 
   return s;
 }
@@ -145,6 +145,8 @@ GST_START_TEST (test_udpsrc)
   GstMemory *mem;
   gchar data[48000];
   gsize max_size;
+  GstStructure *stats;
+  guint64 packets_received;
   int i, len = 0;
   gssize sent;
   GError *err = NULL;
@@ -222,6 +224,14 @@ GST_START_TEST (test_udpsrc)
   gst_memory_get_sizes (mem, NULL, &max_size);
   fail_unless (max_size <= 2000);
 
+  g_object_get (udpsrc, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "packets-received",
+          &packets_received));
+  fail_unless_equals_uint64 (packets_received, 5);
+  fail_unless (gst_structure_has_field_typed (stats, "kernel-drops",
+          G_TYPE_UINT64));
+  gst_structure_free (stats);
+
   g_list_foreach (buffers, (GFunc) gst_buffer_unref, NULL);
   g_list_free (buffers);
   buffers = NULL;
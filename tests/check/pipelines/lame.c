@@ -22,6 +22,7 @@
 
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstbufferstraw.h>
+#include <math.h>
 
 #ifndef ENCODER
 #define ENCODER "lamemp3enc"
@@ -110,6 +111,109 @@ GST_START_TEST (test_caps_proxy)
 
 GST_END_TEST;
 
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define S16_FORMAT "S16LE"
+#else
+#define S16_FORMAT "S16BE"
+#endif
+
+static void
+collect_samples (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    GByteArray * samples)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  g_byte_array_append (samples, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* encode 20 seconds of a sine tone and decode it again */
+static GByteArray *
+encode_and_decode_tone (guint threads)
+{
+  GstElement *bin, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *pipe_str;
+  GByteArray *samples;
+  GError *error = NULL;
+
+  pipe_str = g_strdup_printf ("audiotestsrc wave=sine freq=440 volume=0.5 "
+      "num-buffers=200 samplesperbuffer=4410 "
+      "! audio/x-raw,rate=44100,channels=1 "
+      "! " ENCODER " threads=%u ! mpg123audiodec "
+      "! audio/x-raw,format=" S16_FORMAT " "
+      "! fakesink name=sink signal-handoffs=true", threads);
+
+  bin = gst_parse_launch (pipe_str, &error);
+  fail_unless (bin != NULL, "Error parsing pipeline: %s",
+      error ? error->message : "(invalid error)");
+  g_free (pipe_str);
+
+  samples = g_byte_array_new ();
+  sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (collect_samples), samples);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (bin, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (bin);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+
+  return samples;
+}
+
+GST_START_TEST (test_parallel_segments)
+{
+  GstElementFactory *factory;
+  GByteArray *serial, *parallel;
+  const gint16 *a, *b;
+  gdouble mse = 0.0, psnr;
+  guint i, n;
+
+  factory = gst_element_factory_find ("mpg123audiodec");
+  if (factory == NULL) {
+    GST_INFO ("Skipping test, mpg123audiodec not available");
+    return;
+  }
+  gst_object_unref (factory);
+
+  serial = encode_and_decode_tone (1);
+  parallel = encode_and_decode_tone (4);
+
+  /* the same number of frames, joined without gaps */
+  fail_unless (serial->len > 0);
+  fail_unless_equals_int (serial->len, parallel->len);
+
+  a = (const gint16 *) serial->data;
+  b = (const gint16 *) parallel->data;
+  n = serial->len / 2;
+  for (i = 0; i < n; i++) {
+    gdouble diff = a[i] - b[i];
+
+    mse += diff * diff;
+  }
+  mse /= n;
+
+  psnr = mse > 0.0 ? 10.0 * log10 (32767.0 * 32767.0 / mse) : 100.0;
+  GST_INFO ("PSNR of parallel against serial encoding: %f dB", psnr);
+  fail_unless (psnr > 30.0, "PSNR too low: %f dB", psnr);
+
+  g_byte_array_unref (serial);
+  g_byte_array_unref (parallel);
+}
+
+GST_END_TEST;
+
 #endif /* #ifndef GST_DISABLE_PARSE */
 
 static Suite *
@@ -123,6 +227,7 @@ lame_suite (void)
 #ifndef GST_DISABLE_PARSE
   tcase_add_test (tc_chain, test_format);
   tcase_add_test (tc_chain, test_caps_proxy);
+  tcase_add_test (tc_chain, test_parallel_segments);
 #endif
 
   return s;
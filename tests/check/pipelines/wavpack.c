@@ -86,6 +86,9 @@ fakesink_handoff (GstElement * object, GstBuffer * buffer, GstPad * pad,
   gst_adapter_push (adapter, gst_buffer_ref (buffer));
 }
 
+/* lossless round trip, single threaded and with worker threads */
+static const guint encode_decode_threads[] = { 1, 4 };
+
 GST_START_TEST (test_encode_decode)
 {
   GstElement *pipeline;
@@ -119,6 +122,8 @@ GST_START_TEST (test_encode_decode)
 
   wavpackenc = gst_element_factory_make ("wavpackenc", "enc");
   fail_unless (wavpackenc != NULL);
+  g_object_set (G_OBJECT (wavpackenc), "threads",
+      encode_decode_threads[__i__], NULL);
 
   identity2 = gst_element_factory_make ("identity", "identity2");
   fail_unless (identity2 != NULL);
@@ -127,6 +132,8 @@ GST_START_TEST (test_encode_decode)
 
   wavpackdec = gst_element_factory_make ("wavpackdec", "dec");
   fail_unless (wavpackdec != NULL);
+  g_object_set (G_OBJECT (wavpackdec), "threads",
+      encode_decode_threads[__i__], NULL);
 
   identity3 = gst_element_factory_make ("identity", "identity3");
   fail_unless (identity3 != NULL);
@@ -197,7 +204,8 @@ wavpack_suite (void)
   tcase_set_timeout (tc_chain, 60);
 
   suite_add_tcase (s, tc_chain);
-  tcase_add_test (tc_chain, test_encode_decode);
+  tcase_add_loop_test (tc_chain, test_encode_decode, 0,
+      G_N_ELEMENTS (encode_decode_threads));
 
   return s;
 }